@@ -7,6 +7,7 @@
 
 #include "board.h"
 #include "framework/hooks.h"
+#include "framework/outputs.h"
 
 #include <stm32f1xx.h>
 
@@ -38,12 +39,12 @@ void led_on(void) {
 	 * Switch is on the low side:
 	 * LED is off if PIN is low.
 	 */
-    GPIOC->BRR = PIN13;
+    output_clear(OUTPUT_PORT_C, PIN13);
 }
 
 /*
  * Switch LED off
  */
 void led_off(void) {
-    GPIOC->BSRR = PIN13;
+    output_set(OUTPUT_PORT_C, PIN13);
 }
@@ -0,0 +1,268 @@
+/*
+ * Implementation of the motion profile generator.
+ *
+ * Every beat the profile is advanced by
+ *
+ *     a += j;  v += a;  p += v;
+ *
+ * For a segment of n beats with constant jerk j starting at a0, v0 and p0
+ * this sums up to
+ *
+ *     a = a0 + n j
+ *     v = v0 + n a0 + j n (n + 1) / 2
+ *     p = p0 + n v0 + a0 n (n + 1) / 2 + j n (n + 1) (n + 2) / 6
+ *
+ * The position at the end of a profile is linear in its jerk (S-curve)
+ * or acceleration (trapezoid).
+ * So a move is planned by choosing the ramp durations from the limits,
+ * calculating their distance for a unit jerk/acceleration with the formulas above
+ * and scaling them with the largest integer that leaves room for a cruise phase.
+ * The cruise phase runs the rest of the distance.
+ */
+
+#include "motion.h"
+
+static uint64_t ceil_div(uint64_t a, uint64_t b) {
+    return (a + b - 1) / b;
+}
+
+/*
+ * Smallest r with r * r >= x
+ */
+static uint64_t ceil_sqrt(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    uint64_t rest = x;
+    while (bit > rest) bit >>= 2;
+    while (bit != 0) {
+        if (rest >= root + bit) {
+            rest -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root * root < x ? root + 1 : root;
+}
+
+/*
+ * Smallest r with r * r * r >= x
+ */
+static uint64_t ceil_cbrt(uint64_t x) {
+    uint64_t low = 0;
+    uint64_t high = 1 << 21; /* (2^21)^3 = 2^63 */
+    while (low < high) {
+        uint64_t mid = (low + high) / 2;
+        if (mid * mid * mid < x) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/*
+ * Advances a, v and p over a whole segment in closed form.
+ */
+static void advance(int64_t * a, int64_t * v, int64_t * p, const struct motion_segment * segment) {
+    int64_t n = segment->beats;
+    int64_t a0 = segment->acceleration;
+    int64_t j = segment->jerk;
+    *p += n * *v + a0 * (n * (n + 1) / 2) + j * (n * (n + 1) * (n + 2) / 6);
+    *v += n * a0 + j * (n * (n + 1) / 2);
+    *a = a0 + n * j;
+}
+
+/*
+ * Fills the segment table with a profile for a unit jerk or acceleration.
+ */
+static unsigned unit_profile(struct motion_segment * table, int jerk_limited,
+                             unsigned n_j, unsigned n_a, unsigned n_c) {
+    if (!jerk_limited) {
+        table[0] = (struct motion_segment) { n_a, 0,  1 };
+        table[1] = (struct motion_segment) { n_c, 0,  0 };
+        table[2] = (struct motion_segment) { n_a, 0, -1 };
+        return 3;
+    }
+    table[0] = (struct motion_segment) { n_j,  1,  0 };
+    table[1] = (struct motion_segment) { n_a,  0,  n_j };
+    table[2] = (struct motion_segment) { n_j, -1,  n_j };
+    table[3] = (struct motion_segment) { n_c,  0,  0 };
+    table[4] = (struct motion_segment) { n_j, -1,  0 };
+    table[5] = (struct motion_segment) { n_a,  0, -(int64_t) n_j };
+    table[6] = (struct motion_segment) { n_j,  1, -(int64_t) n_j };
+    return 7;
+}
+
+/*
+ * Returns true if the ramps scaled by s leave a cruise phase of at least s peak_v / a beats.
+ * Then a change of the cruise velocity by up to s peak_v / n_c stays within the acceleration limit.
+ */
+static int cruise_fits(uint64_t d, uint64_t s, uint64_t ramp_d, uint64_t peak_v, uint64_t a) {
+    if (ramp_d > d / s) return 0;
+    uint64_t cruise = d - s * ramp_d;
+    return cruise / (s * peak_v) >= ceil_div(s * peak_v, a);
+}
+
+/*
+ * The planning divides by the velocity and the acceleration
+ */
+static int limits_valid(const struct motion_limits * limits) {
+    return limits->velocity > 0 && limits->acceleration > 0 && limits->jerk >= 0;
+}
+
+int motion_limits_init(struct motion_limits * self, unsigned beats_per_second,
+                       int32_t velocity, int32_t acceleration, int32_t jerk) {
+    self->velocity = ((int64_t) velocity << MOTION_FRACTION_BITS) / beats_per_second;
+    self->acceleration = ((int64_t) acceleration << MOTION_FRACTION_BITS) / beats_per_second / beats_per_second;
+    self->jerk = ((int64_t) jerk << MOTION_FRACTION_BITS) / beats_per_second / beats_per_second / beats_per_second;
+    return limits_valid(self) ? 0 : -1;
+}
+
+void motion_init(struct motion * self, const struct motion_limits * limits, int32_t position) {
+    self->position = (int64_t) position << MOTION_FRACTION_BITS;
+    self->velocity = 0;
+    self->acceleration = 0;
+    self->jerk = 0;
+    self->target = position;
+    self->remaining = 0;
+    self->segment = 0;
+    self->segments = 0;
+    self->limits = *limits;
+}
+
+int motion_move(struct motion * self, int32_t target) {
+    if (motion_moving(self) || !limits_valid(&self->limits)) return -1;
+
+    int64_t distance = (int64_t) target - motion_position(self);
+    self->target = target;
+    self->segment = 0;
+    self->segments = 0;
+    if (distance == 0) return 0;
+
+    uint64_t d = (uint64_t) (distance < 0 ? -distance : distance) << MOTION_FRACTION_BITS;
+    uint64_t v = self->limits.velocity;
+    uint64_t a = self->limits.acceleration;
+    uint64_t j = self->limits.jerk;
+    int jerk_limited = j != 0;
+
+    /*
+     * Durations of the jerk phases (n_j) and of the constant acceleration phases (n_a) in beats
+     */
+    uint64_t n_j = 0;
+    uint64_t n_a = 0;
+    if (!jerk_limited) {
+        n_a = ceil_div(v, a);
+        if (d < v * n_a) n_a = ceil_sqrt(ceil_div(d, a));
+    } else {
+        n_j = ceil_div(a, j);
+        if (v <= a * n_j) {
+            /* velocity limit is reached before the acceleration limit */
+            n_j = ceil_sqrt(ceil_div(v, j));
+        } else {
+            n_a = ceil_div(v - a * n_j, a);
+        }
+        uint64_t ramps = v * (2 * n_j + n_a);
+        if (d < ramps && n_a > 0) {
+            /* solve d = a (n_j + n_a) (2 n_j + n_a) for n_a */
+            uint64_t root = ceil_sqrt(n_j * n_j + 4 * ceil_div(d, a));
+            n_a = root > 3 * n_j ? ceil_div(root - 3 * n_j, 2) : 0;
+            if (n_a == 0) n_j = ceil_cbrt(ceil_div(d, 2 * j));
+        } else if (d < ramps) {
+            /* solve d = 2 j n_j^3 for n_j */
+            n_j = ceil_cbrt(ceil_div(d, 2 * j));
+        }
+    }
+
+    /*
+     * Distance (ramp_d), peak velocity and acceleration of the ramps for a unit jerk/acceleration.
+     * The rounding of the durations may make the ramps too long for the distance or the limits:
+     * Then they are shortened, at n_j = 1 or n_a = 1 every distance of at least one unit fits.
+     */
+    struct motion_segment * table = self->segment_table;
+    unsigned segments;
+    uint64_t ramp_d, peak_v, scale_max;
+    for (;;) {
+        segments = unit_profile(table, jerk_limited, n_j, n_a, 0);
+        int64_t unit_a = 0, unit_v = 0, unit_d = 0;
+        for (unsigned i = 0; i < segments / 2; i++) {
+            advance(&unit_a, &unit_v, &unit_d, &table[i]);
+        }
+        peak_v = unit_v;
+        for (unsigned i = segments / 2; i < segments; i++) {
+            advance(&unit_a, &unit_v, &unit_d, &table[i]);
+        }
+        ramp_d = unit_d;
+        uint64_t peak_a = jerk_limited ? n_j : 1;
+        scale_max = jerk_limited ? j : a;
+        if (a / peak_a < scale_max) scale_max = a / peak_a;
+        if (v / peak_v < scale_max) scale_max = v / peak_v;
+        if (scale_max > 0 && cruise_fits(d, 1, ramp_d, peak_v, a)) break;
+        if (jerk_limited && n_a == 0) {
+            n_j--;
+        } else {
+            n_a--;
+        }
+    }
+
+    /* the largest scale within the limits that leaves room for the cruise phase */
+    uint64_t low = 1;
+    uint64_t high = scale_max;
+    while (low < high) {
+        uint64_t mid = high - (high - low) / 2;
+        if (cruise_fits(d, mid, ramp_d, peak_v, a)) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    /*
+     * The cruise phase runs the distance left by the ramps in n_c beats.
+     * Its velocity is lowered by the drift (less than peak / n_c and so than the acceleration limit),
+     * so less than n_c / 2^32 units are left for the end of the move.
+     */
+    int64_t scale = low;
+    uint64_t peak = scale * peak_v;
+    uint64_t cruise = d - scale * ramp_d;
+    uint64_t n_c = ceil_div(cruise, peak);
+    int64_t drift = (int64_t) (cruise / n_c) - (int64_t) peak;
+    table[segments / 2].beats = n_c;
+    if (distance < 0) {
+        scale = -scale;
+        drift = -drift;
+    }
+    for (unsigned i = 0; i < segments; i++) {
+        table[i].jerk *= scale;
+        table[i].acceleration *= scale;
+    }
+    table[segments / 2].velocity = drift;
+    table[segments / 2 + 1].velocity = -drift;
+    self->segments = segments;
+    return 0;
+}
+
+int32_t motion_step(struct motion * self) {
+    while (self->remaining == 0) {
+        if (self->segment == self->segments) return motion_position(self);
+        const struct motion_segment * segment = &self->segment_table[self->segment++];
+        self->remaining = segment->beats;
+        self->jerk = segment->jerk;
+        self->acceleration = segment->acceleration;
+        self->velocity += segment->velocity;
+    }
+
+    self->acceleration += self->jerk;
+    self->velocity += self->acceleration;
+    self->position += self->velocity;
+
+    if (--self->remaining == 0 && self->segment == self->segments) {
+        /* remove the rest of the cruise phase, a fraction of a unit */
+        self->position = (int64_t) self->target << MOTION_FRACTION_BITS;
+        self->velocity = 0;
+        self->acceleration = 0;
+    }
+    return motion_position(self);
+}
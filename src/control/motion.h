@@ -0,0 +1,102 @@
+/*
+ * motion generates jerk limited (S-curve) and acceleration limited (trapezoidal)
+ * motion profiles in fixed-point arithmetic.
+ *
+ * A move is planned once by `motion_move`.
+ * The planning computes the durations of up to seven segments and
+ * the jerk and acceleration of each segment.
+ * After that `motion_step` advances the profile by one beat
+ * with three 64 bit additions and a counter decrement.
+ *
+ * Positions are given in application units (e.g. µs of a servo pulse).
+ * Internally all values are Q32.32 numbers:
+ * The upper 32 bits are the integral part, the lower 32 bits the fraction.
+ * The time unit is one beat.
+ */
+
+#ifndef CONTROL_MOTION_H
+#define CONTROL_MOTION_H
+
+#include <stdint.h>
+
+#define MOTION_FRACTION_BITS 32
+#define MOTION_SEGMENTS       7
+
+/*
+ * Limits of a motion profile per beat as Q32.32 numbers.
+ * A jerk of 0 selects a trapezoidal profile
+ * in which the acceleration jumps between 0 and its limit.
+ */
+struct motion_limits {
+    int64_t velocity;
+    int64_t acceleration;
+    int64_t jerk;
+};
+
+/*
+ * A segment of a profile:
+ * Its acceleration is set and its velocity is corrected at the beginning,
+ * the acceleration is changed by the jerk at every beat.
+ */
+struct motion_segment {
+    unsigned beats;
+    int64_t jerk;
+    int64_t acceleration;
+    int64_t velocity;
+};
+
+struct motion {
+    int64_t position;
+    int64_t velocity;
+    int64_t acceleration;
+    int64_t jerk;
+    int32_t target;
+    unsigned remaining;
+    unsigned segment;
+    unsigned segments;
+    struct motion_limits limits;
+    struct motion_segment segment_table[MOTION_SEGMENTS];
+};
+
+/*
+ * Converts limits given per second into limits per beat.
+ * velocity is given in units/s, acceleration in units/s² and jerk in units/s³.
+ * It returns 0 if the limits are valid and -1 if the velocity or the acceleration
+ * is not positive per beat (e.g. rounded down to 0) or the jerk is negative.
+ */
+int motion_limits_init(struct motion_limits * self, unsigned beats_per_second,
+                        int32_t velocity, int32_t acceleration, int32_t jerk);
+
+/*
+ * Initializes the profile generator at rest at the given position.
+ */
+void motion_init(struct motion * self, const struct motion_limits * limits, int32_t position);
+
+/*
+ * Plans a move from the current position to target.
+ * A move can only be started at rest.
+ * It returns 0 if the move was planned and -1 if a move is still in progress
+ * or the limits are invalid (see `motion_limits_init`).
+ */
+int motion_move(struct motion * self, int32_t target);
+
+/*
+ * Advances the profile by one beat and returns the rounded position.
+ */
+int32_t motion_step(struct motion * self);
+
+/*
+ * Returns the current position rounded to units.
+ */
+static inline int32_t motion_position(const struct motion * self) {
+    return (int32_t) ((self->position + (1LL << (MOTION_FRACTION_BITS - 1))) >> MOTION_FRACTION_BITS);
+}
+
+/*
+ * Returns true if a move is in progress.
+ */
+static inline int motion_moving(const struct motion * self) {
+    return self->remaining != 0 || self->segment != self->segments;
+}
+
+#endif
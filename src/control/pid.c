@@ -0,0 +1,92 @@
+/*
+ * Implementation of the PID controller.
+ *
+ * The integral and derivative terms are kept in output units with 16 fractional bits.
+ * Because the integral is stored after the multiplication with ki
+ * a change of ki does not change the output.
+ *
+ * Anti-windup is done by conditional integration:
+ * If the output is saturated the integral is not moved further into saturation.
+ * Additionally the integral itself is limited to the output range.
+ */
+
+#include "pid.h"
+
+#define FRACTION_BITS 16
+
+static int64_t limit(int64_t value, int32_t min, int32_t max) {
+    if (value > ((int64_t) max << FRACTION_BITS)) return (int64_t) max << FRACTION_BITS;
+    if (value < ((int64_t) min << FRACTION_BITS)) return (int64_t) min << FRACTION_BITS;
+    return value;
+}
+
+static int32_t weighted(int32_t weight, int32_t setpoint) {
+    return (int32_t) (((int64_t) weight * setpoint) >> FRACTION_BITS);
+}
+
+void pid_init(struct pid * self, const struct pid_parameters * parameters) {
+    self->parameters = *parameters;
+    self->integral = 0;
+    self->derivative = 0;
+    self->d_error = 0;
+    self->p_error = 0;
+    self->output = 0;
+    self->manual = 1;
+}
+
+void pid_tune(struct pid * self, const struct pid_parameters * parameters) {
+    /* move the difference of the proportional terms into the integral */
+    int64_t old_p = (int64_t) self->parameters.kp * self->p_error;
+    int64_t new_p = (int64_t) parameters->kp * self->p_error;
+    self->integral += old_p - new_p;
+    self->parameters = *parameters;
+}
+
+void pid_manual(struct pid * self, int32_t output) {
+    self->manual = 1;
+    self->output = output;
+}
+
+void pid_automatic(struct pid * self) {
+    self->manual = 0;
+}
+
+int32_t pid_step(struct pid * self, int32_t setpoint, int32_t measurement) {
+    const struct pid_parameters * parameters = &self->parameters;
+
+    int32_t p_error = weighted(parameters->b, setpoint) - measurement;
+    int32_t d_error = weighted(parameters->c, setpoint) - measurement;
+    int32_t error = setpoint - measurement;
+
+    int64_t p = (int64_t) parameters->kp * p_error;
+    int64_t d = (int64_t) parameters->kd * (d_error - self->d_error);
+    self->derivative += ((d - self->derivative) >> 8) * parameters->filter >> 8;
+    self->d_error = d_error;
+    self->p_error = p_error;
+
+    if (self->manual) {
+        /* track the manual output for a bumpless transfer */
+        self->integral = ((int64_t) self->output << FRACTION_BITS) - p - self->derivative;
+        return self->output;
+    }
+
+    int64_t integral = self->integral + (int64_t) parameters->ki * error;
+    int64_t u = p + integral + self->derivative;
+    if ((u > ((int64_t) parameters->max << FRACTION_BITS) && integral > self->integral)
+     || (u < ((int64_t) parameters->min << FRACTION_BITS) && integral < self->integral)) {
+        integral = self->integral;
+        u = p + integral + self->derivative;
+    }
+    self->integral = limit(integral, parameters->min, parameters->max);
+
+    u = limit(u + (1 << (FRACTION_BITS - 1)), parameters->min, parameters->max);
+    self->output = (int32_t) (u >> FRACTION_BITS);
+    return self->output;
+}
+
+void pid_step_all(struct pid * pids, const int32_t * setpoints, const int32_t * measurements,
+                  int32_t * outputs, unsigned count) {
+    for (unsigned i = 0; i < count; i++) {
+        outputs[i] = pid_step(&pids[i], setpoints[i], measurements[i]);
+    }
+}
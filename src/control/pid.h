@@ -0,0 +1,89 @@
+/*
+ * pid implements a fixed-point PID controller
+ * with setpoint weighting, derivative filter, anti-windup and bumpless transfer.
+ *
+ * The controller is executed once per beat:
+ *
+ *     P = kp (b r - y)
+ *     I = I + ki (r - y)
+ *     D = D + filter (kd ((c r - y) - (c r' - y')) - D)
+ *     u = P + I + D     limited to [min, max]
+ *
+ * r is the setpoint, y the measurement (e.g. from an ADC or an encoder),
+ * r' and y' are the values of the previous beat.
+ * With c = 0 the controller is a PI-D controller:
+ * The derivative acts on the measurement only and a setpoint change does not kick the output.
+ *
+ * Gains, weights and the filter coefficient are Q16.16 numbers (see PID_Q16).
+ * ki and kd are gains per beat: ki = Ki / beats per second, kd = Kd * beats per second.
+ * Setpoints, measurements and outputs are integers in application units.
+ *
+ * A controller is a small struct with all parameters and state side by side,
+ * so many controllers are stepped efficiently from an array by `pid_step_all`.
+ */
+
+#ifndef CONTROL_PID_H
+#define CONTROL_PID_H
+
+#include <stdint.h>
+
+/*
+ * Conversion of constant gains to Q16.16, e.g. PID_Q16(0.25)
+ */
+#define PID_Q16(x) ((int32_t) ((x) * 65536.0))
+
+struct pid_parameters {
+    int32_t kp;     /* proportional gain */
+    int32_t ki;     /* integral gain per beat */
+    int32_t kd;     /* derivative gain per beat */
+    int32_t b;      /* setpoint weight of the proportional term */
+    int32_t c;      /* setpoint weight of the derivative term */
+    int32_t filter; /* derivative filter coefficient in (0, 1], 1 means no filter */
+    int32_t min;    /* output limits */
+    int32_t max;
+};
+
+struct pid {
+    struct pid_parameters parameters;
+    int64_t integral;       /* Q16.16 in output units */
+    int64_t derivative;     /* Q16.16 in output units */
+    int32_t d_error;        /* derivative error of the previous beat */
+    int32_t p_error;        /* proportional error of the previous beat */
+    int32_t output;
+    int32_t manual;
+};
+
+/*
+ * Initializes a controller in manual mode with output 0.
+ */
+void pid_init(struct pid * self, const struct pid_parameters * parameters);
+
+/*
+ * Changes the parameters without a jump of the output.
+ */
+void pid_tune(struct pid * self, const struct pid_parameters * parameters);
+
+/*
+ * Switches to manual mode: The output is set to the given value.
+ * The controller keeps tracking setpoint and measurement
+ * so that a later switch to automatic mode is bumpless.
+ */
+void pid_manual(struct pid * self, int32_t output);
+
+/*
+ * Switches to automatic mode. The output continues at its last value.
+ */
+void pid_automatic(struct pid * self);
+
+/*
+ * Executes one beat of the controller and returns the output.
+ */
+int32_t pid_step(struct pid * self, int32_t setpoint, int32_t measurement);
+
+/*
+ * Executes one beat of count controllers.
+ */
+void pid_step_all(struct pid * pids, const int32_t * setpoints, const int32_t * measurements,
+                  int32_t * outputs, unsigned count);
+
+#endif
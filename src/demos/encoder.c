@@ -0,0 +1,64 @@
+/*
+ * encoder demonstrates the quadrature encoder driver:
+ *
+ *  - Encoder signal A on PA0 (timer 2, channel 1) and PA6 (timer 3, channel 1)
+ *  - Encoder signal B on PA1 (timer 2, channel 2)
+ *
+ * The LED (PC13) is switched on while the encoder turns forward.
+ * Position and velocity can be watched with the debugger in `encoder`.
+ */
+
+#include <stm32f1xx.h>
+#include "drivers/encoder.h"
+#include "framework/hooks.h"
+#include "framework/outputs.h"
+#include "runtime/system.h"
+
+#define PIN0  (1 << 0)
+#define PIN1  (1 << 1)
+#define PIN6  (1 << 6)
+#define PIN13 (1 << 13)
+
+#define BEATS_PER_SECOND 1000
+
+struct encoder encoder;
+
+void setup() {
+    RCC->APB2ENR |= RCC_APB2ENR_IOPAEN
+                  | RCC_APB2ENR_IOPCEN;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN
+                  | RCC_APB1ENR_TIM3EN;
+
+    /*
+     * On Port A
+     *
+     * PIN 0: Encoder A => 8 = Input pull-up/pull-down
+     * PIN 1: Encoder B => 8 = Input pull-up/pull-down
+     * PIN 6: Encoder A => 8 = Input pull-up/pull-down
+     */
+    GPIOA->CRL = 0x48444488;
+    GPIOA->ODR = PIN0 | PIN1 | PIN6;
+
+    /*
+     * On Port C
+     *
+     * PIN 13: LED => 6 = Output open-drain, 2 MHz
+     */
+    GPIOC->CRH = 0x44644444;
+
+    encoder_init(&encoder, TIM2, TIM3, system_apb1_clock);
+}
+
+unsigned init() {
+    return BEATS_PER_SECOND;
+}
+
+void step(unsigned beat) {
+    encoder_update(&encoder);
+    if (encoder_velocity(&encoder) > 0) {
+        output_clear(OUTPUT_PORT_C, PIN13);
+    } else {
+        output_set(OUTPUT_PORT_C, PIN13);
+    }
+}
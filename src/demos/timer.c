@@ -10,6 +10,7 @@
 
 #include <stm32f1xx.h>
 #include <stddef.h>
+#include "runtime/bitband.h"
 
 #define PIN8  (1 << 8)
 #define PIN9  (1 << 9)
@@ -105,18 +106,22 @@ int main(int argc, char **argv)  {
      * main loop to switch on an off LED manually
      */
     while (1) {
-        /* wait for timer4 channel 1 by pulling the status register */
-        while (!(TIM4->SR & TIM_SR_CC1IF));
-
-        /* reset interrupt flag and switch LED on */
-        TIM4->SR &= ~TIM_SR_CC1IF;
+        /* wait for timer4 channel 1 by pulling the flag via its bit-band alias */
+        while (!BITBAND(&TIM4->SR, TIM_SR_CC1IF_Pos));
+
+        /*
+         * reset interrupt flag and switch LED on:
+         * Writing 0 clears the flag, writing 1 has no effect.
+         * So a single store clears it without touching the flags of the ISR.
+         */
+        TIM4->SR = ~TIM_SR_CC1IF;
         GPIOC->BRR = PIN13;
         
         /* wait for timer channel 2 */
-        while (!(TIM4->SR & TIM_SR_CC2IF));
+        while (!BITBAND(&TIM4->SR, TIM_SR_CC2IF_Pos));
 
         /* reset interrupt flag and switch LED on */
-        TIM4->SR &= ~TIM_SR_CC2IF;
+        TIM4->SR = ~TIM_SR_CC2IF;
         GPIOC->BSRR = PIN13;
     }
 }
@@ -161,7 +166,7 @@ void on_timer4() {
     for (int i = 0;  timer4_dispatch_table[i].event != 0; i++) {
         int evt = timer4_dispatch_table[i].event;
         if (TIM4->SR & evt) {
-            TIM4->SR &= ~evt;
+            TIM4->SR = ~evt;
             timer4_dispatch_table[i].isr();
         }
     }
@@ -0,0 +1,97 @@
+/*
+ * Implementation of the quadrature encoder driver.
+ */
+
+#include "encoder.h"
+
+/*
+ * Input filter of the capture channels: sampled with the timer clock, 8 samples (IC1F = 0011)
+ */
+#define INPUT_FILTER 3
+
+void encoder_init(struct encoder * self, TIM_TypeDef * counter, TIM_TypeDef * clock, uint32_t timer_clock) {
+    self->counter = counter;
+    self->clock = clock;
+    self->position = 0;
+    self->edge_position = 0;
+    self->now = 0;
+    self->edge_time = 0;
+    self->velocity = 0;
+    self->edge_valid = 0;
+
+    /*
+     * Counter: encoder mode 3 counts both edges of TI1 and TI2.
+     * IC1 is mapped on TI1 and IC2 on TI2.
+     * Channel 1 captures the count at the rising edges of TI1.
+     */
+    counter->CR1 = 0;
+    counter->SMCR = TIM_SMCR_SMS_1 | TIM_SMCR_SMS_0;
+    counter->CCMR1 = TIM_CCMR1_CC1S_0 | (INPUT_FILTER << TIM_CCMR1_IC1F_Pos)
+                   | TIM_CCMR1_CC2S_0 | (INPUT_FILTER << TIM_CCMR1_IC2F_Pos);
+    counter->CCER = TIM_CCER_CC1E;
+    counter->ARR = 0xFFFF;
+    counter->CNT = 0;
+
+    /*
+     * Clock: free running with ENCODER_CLOCK_FREQUENCY.
+     * Channel 1 captures the time at the rising edges of TI1.
+     */
+    clock->CR1 = 0;
+    clock->PSC = timer_clock / ENCODER_CLOCK_FREQUENCY - 1;
+    clock->CCMR1 = TIM_CCMR1_CC1S_0 | (INPUT_FILTER << TIM_CCMR1_IC1F_Pos);
+    clock->CCER = TIM_CCER_CC1E;
+    clock->ARR = 0xFFFF;
+    clock->EGR = TIM_EGR_UG; /* load the prescaler */
+    clock->SR = 0;
+
+    counter->CR1 = TIM_CR1_CEN;
+    clock->CR1 = TIM_CR1_CEN;
+
+    self->count = counter->CNT;
+    self->time = clock->CNT;
+}
+
+void encoder_update(struct encoder * self) {
+    TIM_TypeDef * counter = self->counter;
+    TIM_TypeDef * clock = self->clock;
+
+    /*
+     * Read the captures before the counters, so that the captured edge is not younger than now.
+     * A capture in between is detected by a changed capture time.
+     */
+    int edge = (clock->SR & TIM_SR_CC1IF) != 0;
+    uint16_t edge_time = 0;
+    uint16_t edge_count = 0;
+    if (edge) {
+        clock->SR = ~TIM_SR_CC1IF;
+        do {
+            edge_time = clock->CCR1;
+            edge_count = counter->CCR1;
+        } while (edge_time != clock->CCR1);
+    }
+
+    uint16_t count = counter->CNT;
+    uint16_t time = clock->CNT;
+    self->position += (int16_t) (count - self->count);
+    self->now += (uint16_t) (time - self->time);
+    self->count = count;
+    self->time = time;
+
+    if (edge) {
+        int64_t position = self->position - (int16_t) (count - edge_count);
+        uint32_t now = self->now - (uint16_t) (time - edge_time);
+        uint32_t dt = now - self->edge_time;
+        if (self->edge_valid && dt != 0) {
+            self->velocity = (int32_t) ((position - self->edge_position) * ENCODER_CLOCK_FREQUENCY / dt);
+        }
+        self->edge_position = position;
+        self->edge_time = now;
+        self->edge_valid = 1;
+    } else if (self->edge_valid) {
+        /* without an edge the speed is below one period of A since the last edge */
+        uint32_t dt = self->now - self->edge_time;
+        int32_t bound = dt ? (int32_t) ((uint64_t) ENCODER_COUNTS_PER_PERIOD * ENCODER_CLOCK_FREQUENCY / dt) : INT32_MAX;
+        if (self->velocity > bound) self->velocity = bound;
+        if (self->velocity < -bound) self->velocity = -bound;
+    }
+}
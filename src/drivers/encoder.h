@@ -0,0 +1,78 @@
+/*
+ * encoder reads a quadrature encoder with the encoder mode of a timer.
+ *
+ * Two timers are used:
+ *  - counter: The timer counts every edge of the encoder signals A and B (TI1 and TI2).
+ *             Channel 1 captures the count at every rising edge of A.
+ *  - clock:   A free running timer with channel 1 also connected to A.
+ *             It captures the time of every rising edge of A.
+ *
+ * Counting and capturing is done by the hardware.
+ * The CPU is only needed by `encoder_update` once per beat.
+ * It extends the 16 bit count to a 64 bit position
+ * and estimates the velocity with the M/T method:
+ * Counts (M) and time (T) are both taken between two rising edges of A,
+ * so the estimate is exact at high speed and at low speed.
+ *
+ * The 16 bit counters limit the time between two updates:
+ * At most 32767 counts and 65535 clock ticks (65 ms with 1 MHz) are allowed.
+ *
+ * The board has to enable the clocks of both timers
+ * and configure the pins as inputs.
+ */
+
+#ifndef DRIVERS_ENCODER_H
+#define DRIVERS_ENCODER_H
+
+#include <stdint.h>
+#include <stm32f1xx.h>
+
+/*
+ * Tick frequency of the clock timer
+ */
+#define ENCODER_CLOCK_FREQUENCY 1000000
+
+/*
+ * Counts per period of the A signal
+ */
+#define ENCODER_COUNTS_PER_PERIOD 4
+
+struct encoder {
+    TIM_TypeDef * counter;
+    TIM_TypeDef * clock;
+    int64_t position;
+    int64_t edge_position;
+    uint32_t now;
+    uint32_t edge_time;
+    int32_t velocity;
+    uint16_t count;
+    uint16_t time;
+    int edge_valid;
+};
+
+/*
+ * Configures the counter timer in encoder mode and the clock timer for input capture.
+ * timer_clock is the input frequency of the clock timer.
+ */
+void encoder_init(struct encoder * self, TIM_TypeDef * counter, TIM_TypeDef * clock, uint32_t timer_clock);
+
+/*
+ * Updates position and velocity. It has to be called every beat.
+ */
+void encoder_update(struct encoder * self);
+
+/*
+ * Position in counts
+ */
+static inline int64_t encoder_position(const struct encoder * self) {
+    return self->position;
+}
+
+/*
+ * Velocity in counts per second
+ */
+static inline int32_t encoder_velocity(const struct encoder * self) {
+    return self->velocity;
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * debounce filters the bouncing of switches and buttons with a vertical counter.
+ *
+ * Every input bit has a 2 bit counter.
+ * The two bits of all counters are stored "vertically" in two words,
+ * so all inputs of a port are debounced at once with a few logic operations.
+ * An input changes its stable level if it differs from it in DEBOUNCE_SAMPLES consecutive samples.
+ * Any sample equal to the stable level resets its counter.
+ *
+ * One bit per input: A GPIO port uses the lower 16 bits.
+ */
+
+#ifndef FRAMEWORK_DEBOUNCE_H
+#define FRAMEWORK_DEBOUNCE_H
+
+#include <stdint.h>
+
+/*
+ * The number of samples follows from the width of the counter
+ * and cannot be changed without changing `debounce_update`.
+ */
+#define DEBOUNCE_COUNTER_BITS 2
+#define DEBOUNCE_SAMPLES (1 << DEBOUNCE_COUNTER_BITS)
+
+struct debounce {
+    uint32_t state;
+    uint32_t count0;
+    uint32_t count1;
+    uint32_t rising;
+    uint32_t falling;
+};
+
+/*
+ * Initializes the stable levels
+ */
+static inline void debounce_init(struct debounce * self, uint32_t state) {
+    self->state = state;
+    self->count0 = 0;
+    self->count1 = 0;
+    self->rising = 0;
+    self->falling = 0;
+}
+
+/*
+ * Takes a new sample of all inputs and returns the stable levels
+ */
+static inline uint32_t debounce_update(struct debounce * self, uint32_t sample) {
+    uint32_t delta = sample ^ self->state;
+    self->count1 = (self->count1 ^ self->count0) & delta;
+    self->count0 = ~self->count0 & delta;
+    uint32_t toggle = delta & ~(self->count0 | self->count1);
+    self->state ^= toggle;
+    self->rising = toggle & self->state;
+    self->falling = toggle & ~self->state;
+    return self->state;
+}
+
+/*
+ * Stable levels of the inputs
+ */
+static inline uint32_t debounce_state(const struct debounce * self) {
+    return self->state;
+}
+
+/*
+ * Inputs that became high or low with the last sample
+ */
+static inline uint32_t debounce_rising(const struct debounce * self) {
+    return self->rising;
+}
+
+static inline uint32_t debounce_falling(const struct debounce * self) {
+    return self->falling;
+}
+
+#endif
@@ -29,4 +29,12 @@ unsigned init();
  */
 void step(unsigned beat);
 
+/*
+ * Background is called in the main loop if `step` is executed in the beat interrupt
+ * (STEP_IN_INTERRUPT). It may be interrupted by the step at any time.
+ * After it returns the processor sleeps until the next interrupt.
+ * Implementing it is optional.
+ */
+void background();
+
 #endif /* _RUNTIME_CALLBACK_H_ */
@@ -0,0 +1,47 @@
+/*
+ * Implementation of the input stage
+ */
+
+#include "inputs.h"
+#include <stm32f1xx.h>
+
+static struct input_snapshot input_snapshots[2];
+
+const struct input_snapshot * input_current = &input_snapshots[0];
+
+static unsigned input_ports;
+static unsigned input_adc_channels;
+
+static GPIO_TypeDef * const input_gpio[INPUT_PORTS] = {
+    GPIOA,
+    GPIOB,
+    GPIOC,
+    GPIOD
+};
+
+void input_config(unsigned ports, unsigned adc_channels) {
+    input_ports = ports;
+    input_adc_channels = adc_channels;
+}
+
+void input_capture(unsigned beat) {
+    struct input_snapshot * snapshot = &input_snapshots[beat & 1];
+    snapshot->beat = beat;
+
+    for (unsigned ports = input_ports, port = 0; ports != 0; ports >>= 1, port++) {
+        if (ports & 1) snapshot->gpio[port] = input_gpio[port]->IDR;
+    }
+
+    if (input_adc_channels) {
+        volatile uint32_t * jdr = &ADC1->JDR1;
+        for (unsigned channel = 0; channel < input_adc_channels; channel++) {
+            snapshot->adc[channel] = jdr[channel];
+        }
+        /* start the conversion for the next beat */
+        ADC1->CR2 |= ADC_CR2_JSWSTART;
+    }
+}
+
+void input_select(unsigned beat) {
+    input_current = &input_snapshots[beat & 1];
+}
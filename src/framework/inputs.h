@@ -0,0 +1,74 @@
+/*
+ * inputs is the input stage of the framework.
+ *
+ * The board configures which GPIO ports and how many injected ADC channels are inputs.
+ * They are sampled in the beat interrupt at the edge of every beat
+ * and the snapshot is handed over to `step`.
+ * So all inputs of a step are taken at the same, fixed instant
+ * independent of the time `step` needs to get to them.
+ *
+ * The ADC values are the results of the conversions
+ * started by the snapshot of the previous beat.
+ *
+ * The snapshots are double buffered: The snapshot of a beat is valid until the next beat ends.
+ */
+
+#ifndef FRAMEWORK_INPUTS_H
+#define FRAMEWORK_INPUTS_H
+
+#include <stdint.h>
+
+enum input_port {
+    INPUT_PORT_A,
+    INPUT_PORT_B,
+    INPUT_PORT_C,
+    INPUT_PORT_D,
+    INPUT_PORTS
+};
+
+#define INPUT_ADC_CHANNELS 4
+
+struct input_snapshot {
+    unsigned beat;
+    uint16_t gpio[INPUT_PORTS];
+    uint16_t adc[INPUT_ADC_CHANNELS];
+};
+
+/*
+ * Snapshot of the current step
+ */
+extern const struct input_snapshot * input_current;
+
+/*
+ * Configures the inputs sampled at every beat:
+ * ports is a bit mask of input ports, e.g. 1 << INPUT_PORT_A.
+ * adc_channels is the number of injected channels of ADC1 (0 .. 4).
+ * ADC1 has to be set up by the board with JEXTSEL = JSWSTART.
+ */
+void input_config(unsigned ports, unsigned adc_channels);
+
+/*
+ * Takes the snapshot for beat. It is called by the framework at the beat edge.
+ */
+void input_capture(unsigned beat);
+
+/*
+ * Selects the snapshot of beat for the step. It is called by the framework.
+ */
+void input_select(unsigned beat);
+
+/*
+ * Input levels of a port at the beat edge
+ */
+static inline uint16_t input_port(enum input_port port) {
+    return input_current->gpio[port];
+}
+
+/*
+ * Value of an injected ADC channel at the beat edge
+ */
+static inline uint16_t input_adc(unsigned channel) {
+    return input_current->adc[channel];
+}
+
+#endif
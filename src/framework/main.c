@@ -1,15 +1,91 @@
 #include "hooks.h"
+#include "inputs.h"
+#include "outputs.h"
+#include "runtime/profile.h"
 #include "runtime/system.h"
+#include "runtime/trace.h"
 
 static unsigned volatile system_beat = 0;
 
 /*
- * Callback of the SysTick counter increments the system beat
+ * Beat edge: takes the input snapshot of the new beat and increments the system beat.
+ * With STEP_IN_INTERRUPT it also commits the outputs of the last step
+ * and executes the step of the new beat.
  */
-void on_sys_tick() {
+static void beat() {
+#if defined(STEP_IN_INTERRUPT)
+    output_commit();
+#endif
+    input_capture(system_beat + 1);
     system_beat++;
+    trace_record(TRACE_BEAT, system_beat);
+#if defined(STEP_IN_INTERRUPT)
+    input_select(system_beat);
+    trace_record(TRACE_STEP_BEGIN, system_beat);
+    step(system_beat);
+    trace_record(TRACE_STEP_END, 0);
+#endif
+}
+
+/*
+ * Define STEP_IN_INTERRUPT to execute `step` directly in the beat interrupt
+ * instead of the main loop. The step starts a fixed number of cycles after the beat edge
+ * without the wake up and loop overhead of the main loop.
+ * The priority of the beat interrupt is declared by the board in its priority table
+ * (see runtime/irq.h), the framework does not change it. Without an entry it is 0 (highest).
+ * The main loop executes `background` instead.
+ */
+
+#if defined(BEAT_TIMER)
+
+#include <stm32f1xx.h>
+
+/*
+ * The beat is the update event of a timer instead of the SysTick,
+ * e.g. the timer that generates a PWM signal.
+ * Define BEAT_TIMER (e.g. TIM4), BEAT_TIMER_IRQ (e.g. TIM4_IRQn)
+ * and BEAT_TIMER_HANDLER (e.g. on_timer4) to use it.
+ *
+ * The board sets up the timer and its period,
+ * `init` must return the matching beats per second.
+ * The auto reload register is preloaded by the framework.
+ * The board should enable the preload of its compare registers (OCxPE) as well:
+ * Then the values written during a step take effect with the next update event,
+ * so the step is phase locked to the output and runs exactly once per period.
+ */
+void BEAT_TIMER_HANDLER() {
+    BEAT_TIMER->SR = (uint32_t) ~TIM_SR_UIF;
+    beat();
+}
+
+static void beat_config(unsigned beats_per_second) {
+    BEAT_TIMER->CR1 |= TIM_CR1_ARPE;
+    BEAT_TIMER->DIER |= TIM_DIER_UIE;
+    NVIC_EnableIRQ(BEAT_TIMER_IRQ);
 }
 
+#else
+
+/*
+ * Callback of the SysTick counter is the beat
+ */
+void on_sys_tick() {
+    beat();
+}
+
+static void beat_config(unsigned beats_per_second) {
+    system_tick_config(system_core_clock / beats_per_second);
+}
+
+#endif
+
+/*
+ * Default background does nothing
+ */
+__attribute__((weak)) void background() {
+}
+
+#if !defined(STEP_IN_INTERRUPT)
 /*
  * waits (if necessary) for the next beat of current beat and returns it
  */
@@ -19,24 +95,46 @@ static unsigned next_beat(unsigned current_beat)  {
     }
     return system_beat;
 }
+#endif
 
 /*
  * Standard main function an embedded application.
  * It sets up the board, initializes the application
  * and steps through it driven by the system beat.
+ * The inputs of a step are sampled at the beginning of its beat,
+ * the outputs of a step are committed at the beginning of the next beat.
  */
 int main(int argc, char** argv) {
     unsigned current_beat = 0;
 
     system_core_clock_update();
     setup();
+    output_init();
 
     unsigned beats_per_second = init();
-    system_tick_config(system_core_clock / beats_per_second);
+#if defined(PROFILE)
+    profile_start(PROFILE_FREQUENCY);
+#endif
+    input_capture(current_beat);
+#if defined(STEP_IN_INTERRUPT)
+    step(current_beat);
+    beat_config(beats_per_second);
+
+    while (1) {
+        background();
+        system_wait_for_event();
+    }
+#else
+    beat_config(beats_per_second);
 
     while (1) {
+    	trace_record(TRACE_STEP_BEGIN, current_beat);
     	step(current_beat);
+    	trace_record(TRACE_STEP_END, 0);
     	current_beat = next_beat(current_beat);
+    	output_commit();
+    	input_select(current_beat);
     }
+#endif
     return 0;
 }
@@ -0,0 +1,39 @@
+/*
+ * Implementation of the output stage
+ */
+
+#include "outputs.h"
+#include <stm32f1xx.h>
+
+uint16_t output_shadow[OUTPUT_PORTS];
+
+/*
+ * Output levels of the last commit
+ */
+static uint16_t output_committed[OUTPUT_PORTS];
+
+static GPIO_TypeDef * const output_gpio[OUTPUT_PORTS] = {
+    GPIOA,
+    GPIOB,
+    GPIOC,
+    GPIOD
+};
+
+void output_init() {
+    for (int port = 0; port < OUTPUT_PORTS; port++) {
+        output_shadow[port] = output_gpio[port]->ODR;
+        output_committed[port] = output_shadow[port];
+    }
+}
+
+void output_commit() {
+    for (int port = 0; port < OUTPUT_PORTS; port++) {
+        uint16_t shadow = output_shadow[port];
+        uint16_t changed = shadow ^ output_committed[port];
+        if (changed) {
+            /* lower half sets pins, upper half resets pins */
+            output_gpio[port]->BSRR = (shadow & changed) | ((uint32_t) (~shadow & changed) << 16);
+            output_committed[port] = shadow;
+        }
+    }
+}
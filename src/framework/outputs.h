@@ -0,0 +1,66 @@
+/*
+ * outputs is the output stage of the framework.
+ *
+ * The board does not write the GPIO output registers directly.
+ * It changes a shadow of the output levels during `step`.
+ * At the beginning of every beat the framework commits the shadow to the ports:
+ * Every port with changed pins gets exactly one write to its BSRR register
+ * that sets and resets only the changed pins.
+ *
+ * So all outputs change at the same instant of a beat,
+ * independent of the path the code has taken through `step`,
+ * and ports without changes are not accessed at all.
+ */
+
+#ifndef FRAMEWORK_OUTPUTS_H
+#define FRAMEWORK_OUTPUTS_H
+
+#include <stdint.h>
+
+enum output_port {
+    OUTPUT_PORT_A,
+    OUTPUT_PORT_B,
+    OUTPUT_PORT_C,
+    OUTPUT_PORT_D,
+    OUTPUT_PORTS
+};
+
+/*
+ * Output levels to be committed at the next beat
+ */
+extern uint16_t output_shadow[OUTPUT_PORTS];
+
+/*
+ * Sets the pins of a port to high
+ */
+static inline void output_set(enum output_port port, uint16_t pins) {
+    output_shadow[port] |= pins;
+}
+
+/*
+ * Sets the pins of a port to low
+ */
+static inline void output_clear(enum output_port port, uint16_t pins) {
+    output_shadow[port] &= ~pins;
+}
+
+/*
+ * Sets the pins of a port selected by mask to value
+ */
+static inline void output_write(enum output_port port, uint16_t mask, uint16_t value) {
+    output_shadow[port] = (output_shadow[port] & ~mask) | (value & mask);
+}
+
+/*
+ * Takes over the current output levels of all ports into the shadow.
+ * It is called by the framework after `setup`.
+ */
+void output_init();
+
+/*
+ * Writes the changed pins of all ports.
+ * It is called by the framework at the beginning of every beat.
+ */
+void output_commit();
+
+#endif
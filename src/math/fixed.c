@@ -0,0 +1,208 @@
+/*
+ * Implementation of the fixed-point functions that are too big to be inlined.
+ *
+ * The Cortex-M3 multiplies 32 x 32 => 64 bit in 3 to 5 cycles
+ * but a 64 bit division is a library call.
+ * So reciprocals and square roots are computed by Newton-Raphson iterations
+ * that only use multiplications, seeded by a small table.
+ */
+
+#include "fixed.h"
+
+/*
+ * 1/sqrt(v) as Q30 for v = (i + 0.5) / 32 with i = 8 .. 31.
+ */
+static const uint32_t rsqrt_seed[] = {
+    2083365155, 1970666148, 1874477404, 1791125178, 1717986918, 1653133683,
+    1595110809, 1542797797, 1495315679, 1451963954, 1412176548, 1375490368,
+    1341522400, 1309952745, 1280511845, 1252970736, 1227133513, 1202831433,
+    1179918260, 1158266544, 1137764631, 1118314230, 1099828424, 1082230034
+};
+
+/*
+ * sin(i * pi/512) for i = 0 .. 256 scaled by 32768 (a quarter of a turn).
+ */
+static const uint16_t sin_table[] = {
+        0,   201,   402,   603,   804,  1005,  1206,  1407,
+     1608,  1809,  2009,  2210,  2411,  2611,  2811,  3012,
+     3212,  3412,  3612,  3812,  4011,  4211,  4410,  4609,
+     4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,
+     6393,  6590,  6787,  6983,  7180,  7376,  7571,  7767,
+     7962,  8157,  8351,  8546,  8740,  8933,  9127,  9319,
+     9512,  9704,  9896, 10088, 10279, 10469, 10660, 10850,
+    11039, 11228, 11417, 11605, 11793, 11980, 12167, 12354,
+    12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+    14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+    15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673,
+    16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358,
+    19520, 19681, 19841, 20001, 20160, 20318, 20475, 20632,
+    20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+    22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028,
+    23170, 23312, 23453, 23593, 23732, 23870, 24008, 24144,
+    24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199,
+    26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+    27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+    28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803,
+    28899, 28993, 29086, 29178, 29269, 29359, 29448, 29535,
+    29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784,
+    30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298,
+    31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+    31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099,
+    32138, 32177, 32214, 32251, 32286, 32319, 32352, 32383,
+    32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718,
+    32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+    32768
+};
+
+/*
+ * atan(2^-i) as binary angle of a 32 bit turn.
+ */
+static const uint32_t atan_table[] = {
+    0x20000000, 0x12E4051E, 0x09FB385B, 0x051111D4, 0x028B0D43, 0x0145D7E1,
+    0x00A2F61E, 0x00517C55, 0x0028BE53, 0x00145F2F, 0x000A2F98, 0x000517CC,
+    0x00028BE6, 0x000145F3, 0x0000A2FA, 0x0000517D, 0x000028BE, 0x0000145F,
+    0x00000A30, 0x00000518, 0x0000028C, 0x00000146, 0x000000A3, 0x00000051
+};
+
+#define CORDIC_ITERATIONS (sizeof(atan_table) / sizeof(atan_table[0]))
+
+q31_t fixed_reciprocal(uint32_t x, int * exponent) {
+    if (x == 0) {
+        *exponent = 0;
+        return Q31_MAX;
+    }
+
+    /* normalize x to d in [0.5, 1) as Q32 */
+    int n = __builtin_clz(x);
+    uint32_t d = x << n;
+    *exponent = 31 - n;
+
+    /* y = 1/d in Q30, seed 48/17 - 32/17 d has an error below 1/17 */
+    uint32_t y = 3031741622U - (uint32_t) (((uint64_t) 2021161080U * d) >> 32);
+    for (int i = 0; i < 3; i++) {
+        uint32_t e = 0x80000000U - (uint32_t) (((uint64_t) d * y) >> 32);
+        y = (uint32_t) (((uint64_t) y * e) >> 30);
+    }
+
+    /* y/2 in Q31 is y in Q30 */
+    return y > Q31_MAX ? Q31_MAX : (q31_t) y;
+}
+
+q31_t q31_div(q31_t n, q31_t d) {
+    if (d == 0) return n < 0 ? Q31_MIN : Q31_MAX;
+
+    int negative = (n < 0) != (d < 0);
+    uint32_t dividend = n < 0 ? -(uint32_t) n : (uint32_t) n;
+    uint32_t divisor = d < 0 ? -(uint32_t) d : (uint32_t) d;
+
+    int exponent;
+    q31_t m = fixed_reciprocal(divisor, &exponent);
+    uint64_t q = ((uint64_t) dividend * (uint32_t) m) >> exponent;
+    return negative ? q31_sat(-(int64_t) q) : q31_sat((int64_t) q);
+}
+
+/*
+ * sqrt(X / 2^32) as Q32 for X in [2^30, 2^32).
+ * Newton-Raphson iteration for y = 1/sqrt(v): y = y (3 - v y^2) / 2
+ */
+static uint32_t sqrt_normalized(uint32_t x) {
+    uint32_t y = rsqrt_seed[(x >> 27) - 8];
+    for (int i = 0; i < 3; i++) {
+        uint64_t y2 = ((uint64_t) y * y) >> 30;
+        uint32_t vy2 = (uint32_t) ((x * y2) >> 32);
+        y = (uint32_t) (((uint64_t) y * (3U * (1U << 30) - vy2)) >> 31);
+    }
+    uint64_t r = ((uint64_t) x * y) >> 30;
+    return r > UINT32_MAX ? UINT32_MAX : (uint32_t) r;
+}
+
+uint32_t fixed_sqrt(uint32_t x) {
+    if (x == 0) return 0;
+
+    int s = __builtin_clz(x) & ~1;
+    uint32_t y = sqrt_normalized(x << s) >> (16 + s / 2);
+
+    /* the approximation is off by at most one */
+    if (y > 0xFFFF) y = 0xFFFF;
+    if (y * y > x) y--;
+    else if ((uint64_t) (y + 1) * (y + 1) <= x) y++;
+    return y;
+}
+
+q15_t q15_sqrt(q15_t x) {
+    if (x <= 0) return 0;
+    return (q15_t) fixed_sqrt((uint32_t) x << 15);
+}
+
+q31_t q31_sqrt(q31_t x) {
+    if (x <= 0) return 0;
+
+    /* an odd shift keeps the exponent of the Q31 value even */
+    int c = __builtin_clz((uint32_t) x);
+    int s = (c & 1) ? c : c - 1;
+    return (q31_t) (sqrt_normalized((uint32_t) x << s) >> ((s + 1) / 2));
+}
+
+q15_t q15_sin(uint16_t angle) {
+    unsigned quadrant = angle >> 14;
+    unsigned index = angle & 0x3FFF;
+    if (quadrant & 1) index = 0x4000 - index;
+
+    unsigned i = index >> 6;
+    int32_t value = sin_table[i];
+    unsigned fraction = index & 0x3F;
+    if (fraction) value += ((sin_table[i + 1] - value) * (int32_t) fraction) >> 6;
+
+    if (quadrant & 2) value = -value;
+    return q15_sat(value);
+}
+
+q15_t q15_cos(uint16_t angle) {
+    return q15_sin(angle + ANGLE_TURN / 4);
+}
+
+int16_t fixed_atan2(int32_t y, int32_t x) {
+    int64_t xx = x;
+    int64_t yy = y;
+    uint32_t angle = 0;
+
+    /* rotate into the right half plane */
+    if (xx < 0) {
+        xx = -xx;
+        yy = -yy;
+        angle = 0x80000000U;
+    }
+
+    /* scale to 29 bits to use the full precision without overflow */
+    uint64_t m = (uint64_t) xx | (uint64_t) (yy < 0 ? -yy : yy);
+    if (m == 0) return 0;
+    int shift = 63 - __builtin_clzll(m) - 28;
+    if (shift > 0) {
+        xx >>= shift;
+        yy >>= shift;
+    } else {
+        xx <<= -shift;
+        yy <<= -shift;
+    }
+
+    int32_t cx = (int32_t) xx;
+    int32_t cy = (int32_t) yy;
+    for (unsigned i = 0; i < CORDIC_ITERATIONS; i++) {
+        int32_t dx = cy >> i;
+        int32_t dy = cx >> i;
+        if (cy > 0) {
+            cx += dx;
+            cy -= dy;
+            angle += atan_table[i];
+        } else {
+            cx -= dx;
+            cy += dy;
+            angle -= atan_table[i];
+        }
+    }
+    return (int16_t) ((angle + 0x8000U) >> 16);
+}
@@ -0,0 +1,169 @@
+/*
+ * fixed provides fixed-point arithmetic for control applications.
+ *
+ * The Cortex-M3 has no floating point unit.
+ * Every float operation is emulated by a library call that costs
+ * tens to hundreds of cycles.
+ * The Q15 and Q31 formats represent numbers in the range [-1, 1)
+ * with 15 or 31 fractional bits and are processed by the integer unit:
+ *
+ *     q15_t:  x / 2^15
+ *     q31_t:  x / 2^31
+ *
+ * Angles are binary angles: A full turn is 65536, so they wrap around naturally.
+ *
+ * The simple operations are inline functions.
+ * On the Cortex-M3 they map to SSAT, SMULL and SMLAL instructions.
+ */
+
+#ifndef MATH_FIXED_H
+#define MATH_FIXED_H
+
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+#define Q15_MAX INT16_MAX
+#define Q15_MIN INT16_MIN
+#define Q31_MAX INT32_MAX
+#define Q31_MIN INT32_MIN
+
+/*
+ * Conversion of constants, e.g. Q15(0.5). Use them only with constant expressions.
+ */
+#define Q15(x) ((q15_t) ((x) >= 1.0 ? Q15_MAX : (x) * 32768.0))
+#define Q31(x) ((q31_t) ((x) >= 1.0 ? Q31_MAX : (x) * 2147483648.0))
+
+/*
+ * Binary angle: 65536 is a full turn.
+ */
+#define ANGLE_TURN 65536
+
+/*
+ * Saturates a 32 bit value to the Q15 range.
+ */
+static inline q15_t q15_sat(int32_t x) {
+#if defined(__ARM_FEATURE_SAT)
+    return (q15_t) __ssat(x, 16);
+#else
+    if (x > Q15_MAX) return Q15_MAX;
+    if (x < Q15_MIN) return Q15_MIN;
+    return (q15_t) x;
+#endif
+}
+
+/*
+ * Saturates a 64 bit value to the Q31 range.
+ */
+static inline q31_t q31_sat(int64_t x) {
+    if (x > Q31_MAX) return Q31_MAX;
+    if (x < Q31_MIN) return Q31_MIN;
+    return (q31_t) x;
+}
+
+static inline q15_t q15_add(q15_t a, q15_t b) {
+    return q15_sat((int32_t) a + b);
+}
+
+static inline q15_t q15_sub(q15_t a, q15_t b) {
+    return q15_sat((int32_t) a - b);
+}
+
+static inline q15_t q15_mul(q15_t a, q15_t b) {
+    return q15_sat(((int32_t) a * b) >> 15);
+}
+
+static inline q31_t q31_add(q31_t a, q31_t b) {
+    return q31_sat((int64_t) a + b);
+}
+
+static inline q31_t q31_sub(q31_t a, q31_t b) {
+    return q31_sat((int64_t) a - b);
+}
+
+/*
+ * 32 x 32 => 64 bit signed multiplication (SMULL)
+ */
+static inline int64_t smull(int32_t a, int32_t b) {
+#if defined(__ARM_ARCH_7M__)
+    uint32_t low;
+    int32_t high;
+    __asm__ ("smull %0, %1, %2, %3" : "=r" (low), "=r" (high) : "r" (a), "r" (b));
+    return (int64_t) (((uint64_t) (uint32_t) high << 32) | low);
+#else
+    return (int64_t) a * b;
+#endif
+}
+
+/*
+ * 32 x 32 + 64 => 64 bit signed multiply accumulate (SMLAL)
+ */
+static inline int64_t smlal(int64_t acc, int32_t a, int32_t b) {
+#if defined(__ARM_ARCH_7M__)
+    uint32_t low = (uint32_t) acc;
+    int32_t high = (int32_t) (acc >> 32);
+    __asm__ ("smlal %0, %1, %2, %3" : "+r" (low), "+r" (high) : "r" (a), "r" (b));
+    return (int64_t) (((uint64_t) (uint32_t) high << 32) | low);
+#else
+    return acc + (int64_t) a * b;
+#endif
+}
+
+static inline q31_t q31_mul(q31_t a, q31_t b) {
+    return q31_sat(smull(a, b) >> 31);
+}
+
+/*
+ * Multiply accumulate into a Q62 accumulator.
+ * q31_mac_result converts the accumulator back to Q31 with saturation.
+ */
+static inline int64_t q31_mac(int64_t acc, q31_t a, q31_t b) {
+    return smlal(acc, a, b);
+}
+
+static inline q31_t q31_mac_result(int64_t acc) {
+    return q31_sat(acc >> 31);
+}
+
+/*
+ * Reciprocal 1/x of a positive integer x.
+ * The result is a Q31 mantissa m in (0.5, 1] (saturated) and an exponent e:
+ *
+ *     1/x = m * 2^-e
+ *
+ * The relative error is below 2^-29.
+ */
+q31_t fixed_reciprocal(uint32_t x, int * exponent);
+
+/*
+ * Fractional division n / d with saturation.
+ * The Cortex-M3 has a 32 bit hardware divider but Q31 division needs a 64 bit dividend,
+ * so it is done by a multiplication with the reciprocal of d.
+ */
+q31_t q31_div(q31_t n, q31_t d);
+
+/*
+ * Square roots of non negative numbers, negative numbers give 0.
+ */
+uint32_t fixed_sqrt(uint32_t x);
+q15_t q15_sqrt(q15_t x);
+q31_t q31_sqrt(q31_t x);
+
+/*
+ * Sine and cosine of a binary angle as Q15 (table with linear interpolation).
+ */
+q15_t q15_sin(uint16_t angle);
+q15_t q15_cos(uint16_t angle);
+
+/*
+ * Angle of the vector (x, y) as binary angle (CORDIC).
+ * The result is in the range [-32768, 32767] which is [-pi, pi).
+ */
+int16_t fixed_atan2(int32_t y, int32_t x);
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * bitband provides access to single bits via the bit-band alias regions of the Cortex-M3.
+ *
+ * The first MB of SRAM (0x20000000) and of the peripherals (0x40000000)
+ * is mirrored bit by bit into an alias region 0x02000000 above its base:
+ * Every bit has its own 32 bit word in the alias region.
+ *
+ *  - Reading an alias word returns the bit (0 or 1) with one load.
+ *  - Writing an alias word sets or clears the bit with one store.
+ *    The bus does the read-modify-write of the word atomically,
+ *    so an interrupt cannot come in between and no critical section is needed.
+ *
+ * The alias address is computed at compile time if the address is a constant,
+ * e.g. a peripheral register or a global variable:
+ *
+ *     BITBAND(&GPIOC->ODR, 13) = 1;
+ *     while (!BITBAND(&flags, FLAG_READY));
+ *
+ * Caution with status registers whose flags are cleared by writing 0 (rc_w0), like TIMx->SR:
+ * The atomic read-modify-write writes back a 0 for a flag that is set by the hardware
+ * between its read and write and so clears that flag.
+ * Clear such flags with a single store of the inverted mask instead: TIM4->SR = ~TIM_SR_CC1IF;
+ */
+
+#ifndef RUNTIME_BITBAND_H
+#define RUNTIME_BITBAND_H
+
+#include <stdint.h>
+
+#define BITBAND_REGION_MASK 0xF0000000UL
+#define BITBAND_OFFSET_MASK 0x000FFFFFUL
+#define BITBAND_ALIAS       0x02000000UL
+
+/*
+ * Alias address of a bit of the word at address
+ */
+#define BITBAND_ADDRESS(address, bit)                         \
+    ((((uint32_t) (address)) & BITBAND_REGION_MASK)           \
+     + BITBAND_ALIAS                                          \
+     + ((((uint32_t) (address)) & BITBAND_OFFSET_MASK) << 5)  \
+     + ((uint32_t) (bit) << 2))
+
+/*
+ * Alias word of a bit as lvalue
+ */
+#define BITBAND(address, bit) (*(volatile uint32_t *) BITBAND_ADDRESS(address, bit))
+
+static inline void bitband_set(volatile void * address, unsigned bit) {
+    BITBAND(address, bit) = 1;
+}
+
+static inline void bitband_clear(volatile void * address, unsigned bit) {
+    BITBAND(address, bit) = 0;
+}
+
+static inline uint32_t bitband_test(const volatile void * address, unsigned bit) {
+    return BITBAND(address, bit);
+}
+
+#endif
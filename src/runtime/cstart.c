@@ -7,6 +7,7 @@
 #include <string.h>
 
 #include "system.h"
+#include "vector_table.h"
 
 /*
  * main() is the entry point for applications.
@@ -42,7 +43,12 @@ void _start() {
 
     /* initialize data segment */
     memcpy(&__data_start, &__data_load, &__data_end - &__data_start);
-    
+
+#ifdef VECTOR_TABLE_RAM
+    /* relocate the vector table to RAM */
+    vector_table_init();
+#endif
+
     main(0, NULL);
 }
 
@@ -0,0 +1,22 @@
+/*
+ * Implementation of the interrupt priority configuration
+ */
+
+#include "irq.h"
+#include "system.h"
+
+/*
+ * Priority grouping 3: 4 bits of group priority (preemption), 0 bits of sub priority
+ */
+#define PRIORITY_GROUPING 3
+
+uint32_t critical_start;
+volatile uint32_t critical_max_cycles;
+
+void irq_priorities(const struct irq_priority * table, unsigned count) {
+    system_cycle_counter_enable();
+    NVIC_SetPriorityGrouping(PRIORITY_GROUPING);
+    for (unsigned i = 0; i < count; i++) {
+        NVIC_SetPriority(table[i].irq, table[i].priority);
+    }
+}
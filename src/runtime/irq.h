@@ -0,0 +1,77 @@
+/*
+ * irq configures interrupt priorities and provides critical sections.
+ *
+ * All priorities of an application are declared in one table
+ * and set at once by `irq_priorities`.
+ * The STM32F1 has 16 priority levels: 0 is the highest, 15 the lowest.
+ * All bits are used for preemption, so every level can preempt the lower levels.
+ *
+ * A critical section does not disable all interrupts.
+ * It masks only the interrupts with a priority value greater or equal to its level
+ * with the BASEPRI register, so faster interrupts with a higher priority stay live:
+ *
+ *     uint32_t state = critical_enter(4);   // masks priorities 4 .. 15
+ *     ...
+ *     critical_exit(state);
+ *
+ * Critical sections can be nested: An inner section never lowers the level of an outer section.
+ * The level must be 1 or higher: BASEPRI cannot mask priority 0 (BASEPRI = 0 masks nothing).
+ * A constant level 0 is a compile error, a variable level 0 is taken as 1.
+ *
+ * The duration of the outermost critical sections is measured with the DWT cycle counter.
+ * The longest one is kept in `critical_max_cycles`.
+ * The cycle counter is enabled by `irq_priorities` (or `system_cycle_counter_enable`):
+ * Without it `critical_max_cycles` stays 0.
+ */
+
+#ifndef RUNTIME_IRQ_H
+#define RUNTIME_IRQ_H
+
+#include <stdint.h>
+#include <stm32f1xx.h>
+
+#define IRQ_PRIORITY_SHIFT (8 - __NVIC_PRIO_BITS)
+
+struct irq_priority {
+    IRQn_Type irq;
+    uint8_t priority;
+};
+
+/*
+ * Sets the priorities of all interrupts of the table.
+ */
+void irq_priorities(const struct irq_priority * table, unsigned count);
+
+/*
+ * Start of the current outermost critical section and the longest duration in cycles
+ */
+extern uint32_t critical_start;
+extern volatile uint32_t critical_max_cycles;
+
+void critical_level_zero() __attribute__ ((error("critical_enter: level 0 masks nothing, use level 1 or higher")));
+
+/*
+ * Masks all interrupts with a priority value of level (1 .. 15) and higher.
+ * It returns the state to be restored by `critical_exit`.
+ */
+static inline uint32_t critical_enter(unsigned level) {
+    if (__builtin_constant_p(level) && level == 0) critical_level_zero();
+    if (level == 0) level = 1;
+    uint32_t state = __get_BASEPRI();
+    __set_BASEPRI_MAX(level << IRQ_PRIORITY_SHIFT);
+    if (state == 0) critical_start = DWT->CYCCNT;
+    return state;
+}
+
+/*
+ * Restores the state before `critical_enter`.
+ */
+static inline void critical_exit(uint32_t state) {
+    if (state == 0) {
+        uint32_t cycles = DWT->CYCCNT - critical_start;
+        if (cycles > critical_max_cycles) critical_max_cycles = cycles;
+    }
+    __set_BASEPRI(state);
+}
+
+#endif
@@ -0,0 +1,7 @@
+/*
+ * Ring buffer of the log
+ */
+
+#include "log.h"
+
+struct log_buffer log_buffer;
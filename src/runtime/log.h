@@ -0,0 +1,77 @@
+/*
+ * log is a binary logging facility that defers the formatting to the host.
+ *
+ *     LOG("move from %d to %d", position, target);
+ *
+ * The format string is placed in the section .log_fmt which is kept in the ELF file
+ * but not loaded into the flash. Its address in this section is the id of the format.
+ * A log call writes only the id and up to 3 raw 32 bit arguments into a slot
+ * of a ring buffer in RAM: about 20 cycles and no formatting code on the target.
+ *
+ * The slots are reserved with an atomic increment of the head,
+ * so LOG can be called from `step` and interrupt handlers at the same time.
+ * A slot is marked with LOG_INVALID while it is written;
+ * compiler fences keep the marker and the order of the stores.
+ * The oldest entries are overwritten when the buffer is full.
+ *
+ * The host reads `log_buffer` with the debugger and `tools/log_decode.py`
+ * rebuilds the messages from the format strings in the ELF file.
+ * Supported conversions are %d %i %u %x %X %o %c %p and %s for strings in flash.
+ */
+
+#ifndef RUNTIME_LOG_H
+#define RUNTIME_LOG_H
+
+#include <stdint.h>
+
+/*
+ * Number of slots, must be a power of 2
+ */
+#ifndef LOG_SIZE
+#define LOG_SIZE 64
+#endif
+
+#define LOG_ARGS 3
+
+/*
+ * Marks a slot that is being written
+ */
+#define LOG_INVALID 0xFFFFFFFF
+
+struct log_entry {
+    uint32_t format;
+    uint32_t args[LOG_ARGS];
+};
+
+struct log_buffer {
+    uint32_t head;      /* number of entries written so far */
+    struct log_entry entries[LOG_SIZE];
+};
+
+extern struct log_buffer log_buffer;
+
+static inline void log_write(uint32_t format, uint32_t arg0, uint32_t arg1, uint32_t arg2) {
+    uint32_t index = __atomic_fetch_add(&log_buffer.head, 1, __ATOMIC_RELAXED);
+    struct log_entry * entry = &log_buffer.entries[index & (LOG_SIZE - 1)];
+    entry->format = LOG_INVALID;
+    /* keep the marker: otherwise it is a dead store that the compiler removes */
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    entry->args[0] = arg0;
+    entry->args[1] = arg1;
+    entry->args[2] = arg2;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    entry->format = format;
+}
+
+#define LOG_SELECT_ARGS(dummy, arg0, arg1, arg2, ...) \
+    (uint32_t) (arg0), (uint32_t) (arg1), (uint32_t) (arg2)
+
+/*
+ * Logs the format string with up to 3 integer arguments.
+ */
+#define LOG(format, ...) do { \
+    static const char log_format[] __attribute__ ((section(".log_fmt"), used)) = format; \
+    log_write((uint32_t) (uintptr_t) log_format, LOG_SELECT_ARGS(0, ## __VA_ARGS__, 0, 0, 0)); \
+} while (0)
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Implementation of the copy and fill functions
+ */
+
+#include "memory.h"
+#include <stdint.h>
+
+/* word that may be read from any address, the Cortex-M3 supports unaligned LDR */
+typedef uint32_t unaligned_word __attribute__ ((aligned (1), may_alias));
+
+typedef uint32_t word __attribute__ ((may_alias));
+
+/* the loops must not be replaced by calls of memcpy and memset */
+#define NO_LIBC_CALLS __attribute__ ((optimize ("no-tree-loop-distribute-patterns")))
+
+#define WORD_MASK (sizeof(uint32_t) - 1)
+
+NO_LIBC_CALLS void * runtime_memcpy(void * destination, const void * source, size_t size) {
+    uint8_t * d = destination;
+    const uint8_t * s = source;
+
+    if (size >= 8) {
+        while ((uintptr_t) d & WORD_MASK) {
+            *d++ = *s++;
+            size--;
+        }
+        word * dw = (word *) d;
+        if (((uintptr_t) s & WORD_MASK) == 0) {
+            const word * sw = (const word *) s;
+            for (; size >= 16; size -= 16) {
+                uint32_t a = sw[0], b = sw[1], c = sw[2], e = sw[3];
+                dw[0] = a; dw[1] = b; dw[2] = c; dw[3] = e;
+                sw += 4;
+                dw += 4;
+            }
+            for (; size >= 4; size -= 4) *dw++ = *sw++;
+            s = (const uint8_t *) sw;
+        } else {
+            const unaligned_word * sw = (const unaligned_word *) s;
+            for (; size >= 16; size -= 16) {
+                uint32_t a = sw[0], b = sw[1], c = sw[2], e = sw[3];
+                dw[0] = a; dw[1] = b; dw[2] = c; dw[3] = e;
+                sw += 4;
+                dw += 4;
+            }
+            for (; size >= 4; size -= 4) *dw++ = *sw++;
+            s = (const uint8_t *) sw;
+        }
+        d = (uint8_t *) dw;
+    }
+    while (size--) *d++ = *s++;
+    return destination;
+}
+
+NO_LIBC_CALLS void * runtime_memset(void * destination, int value, size_t size) {
+    uint8_t * d = destination;
+    uint8_t byte = value;
+
+    if (size >= 8) {
+        while ((uintptr_t) d & WORD_MASK) {
+            *d++ = byte;
+            size--;
+        }
+        uint32_t pattern = byte * 0x01010101u;
+        word * dw = (word *) d;
+        for (; size >= 16; size -= 16) {
+            dw[0] = pattern; dw[1] = pattern; dw[2] = pattern; dw[3] = pattern;
+            dw += 4;
+        }
+        for (; size >= 4; size -= 4) *dw++ = pattern;
+        d = (uint8_t *) dw;
+    }
+    while (size--) *d++ = byte;
+    return destination;
+}
+
+/*
+ * Copies downwards from the end if the destination overlaps the end of the source,
+ * otherwise the forward copy is safe: it reads every word before it is overwritten.
+ */
+NO_LIBC_CALLS void * runtime_memmove(void * destination, const void * source, size_t size) {
+    uint8_t * d = destination;
+    const uint8_t * s = source;
+
+    if ((uintptr_t) d - (uintptr_t) s >= size) return runtime_memcpy(destination, source, size);
+
+    d += size;
+    s += size;
+    if (size >= 8) {
+        while ((uintptr_t) d & WORD_MASK) {
+            *--d = *--s;
+            size--;
+        }
+        word * dw = (word *) d;
+        const unaligned_word * sw = (const unaligned_word *) s;
+        for (; size >= 16; size -= 16) {
+            sw -= 4;
+            dw -= 4;
+            uint32_t a = sw[0], b = sw[1], c = sw[2], e = sw[3];
+            dw[0] = a; dw[1] = b; dw[2] = c; dw[3] = e;
+        }
+        for (; size >= 4; size -= 4) *--dw = *--sw;
+        d = (uint8_t *) dw;
+        s = (const uint8_t *) sw;
+    }
+    while (size--) *--d = *--s;
+    return destination;
+}
+
+#ifdef RUNTIME_STRING
+
+void * memcpy(void * destination, const void * source, size_t size)
+    __attribute__ ((alias ("runtime_memcpy")));
+void * memset(void * destination, int value, size_t size)
+    __attribute__ ((alias ("runtime_memset")));
+void * memmove(void * destination, const void * source, size_t size)
+    __attribute__ ((alias ("runtime_memmove")));
+
+#endif
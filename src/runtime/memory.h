@@ -0,0 +1,22 @@
+/*
+ * memory provides copy and fill functions for the Cortex-M3
+ * that are faster than the byte loops of newlib-nano.
+ *
+ * The destination is aligned to words first. Aligned data is moved in bursts of 4 words
+ * (which the compiler turns into LDM/STM with optimization), a source with another
+ * alignment is read with unaligned word loads. The rest is moved by words and bytes.
+ *
+ * With RUNTIME_STRING they replace memcpy, memset and memmove of the C library
+ * for the whole firmware, including the initialisation of the data and the BSS segment.
+ */
+
+#ifndef RUNTIME_MEMORY_H
+#define RUNTIME_MEMORY_H
+
+#include <stddef.h>
+
+void * runtime_memcpy(void * destination, const void * source, size_t size);
+void * runtime_memset(void * destination, int value, size_t size);
+void * runtime_memmove(void * destination, const void * source, size_t size);
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Implementation of the DWT performance counters
+ */
+
+#include "perf.h"
+
+#define COUNTER_MASK 0xFF
+
+void perf_enable() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CPICNT = 0;
+    DWT->EXCCNT = 0;
+    DWT->SLEEPCNT = 0;
+    DWT->LSUCNT = 0;
+    DWT->FOLDCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk
+               | DWT_CTRL_CPIEVTENA_Msk
+               | DWT_CTRL_EXCEVTENA_Msk
+               | DWT_CTRL_SLEEPEVTENA_Msk
+               | DWT_CTRL_LSUEVTENA_Msk
+               | DWT_CTRL_FOLDEVTENA_Msk;
+}
+
+int perf_diff(const struct perf_counters * start, const struct perf_counters * end, struct perf_counters * diff) {
+    diff->cycles = end->cycles - start->cycles;
+    diff->cpi = (end->cpi - start->cpi) & COUNTER_MASK;
+    diff->exceptions = (end->exceptions - start->exceptions) & COUNTER_MASK;
+    diff->sleep = (end->sleep - start->sleep) & COUNTER_MASK;
+    diff->lsu = (end->lsu - start->lsu) & COUNTER_MASK;
+    diff->fold = (end->fold - start->fold) & COUNTER_MASK;
+    return diff->cycles <= COUNTER_MASK;
+}
+
+void perf_start(struct perf_accumulator * self) {
+    self->total = (struct perf_counters) { 0 };
+    self->overflows = 0;
+    perf_read(&self->last);
+}
+
+void perf_accumulate(struct perf_accumulator * self) {
+    struct perf_counters now, diff;
+    perf_read(&now);
+    if (!perf_diff(&self->last, &now, &diff)) self->overflows++;
+    self->total.cycles += diff.cycles;
+    self->total.cpi += diff.cpi;
+    self->total.exceptions += diff.exceptions;
+    self->total.sleep += diff.sleep;
+    self->total.lsu += diff.lsu;
+    self->total.fold += diff.fold;
+    self->last = now;
+}
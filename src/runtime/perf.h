@@ -0,0 +1,91 @@
+/*
+ * perf reads the performance counters of the DWT (data watchpoint and trace unit).
+ *
+ *  - cycles:     processor cycles (32 bit)
+ *  - cpi:        additional cycles of multi-cycle instructions and instruction fetch stalls,
+ *                e.g. flash wait states (8 bit)
+ *  - exceptions: cycles of exception entry and exit (8 bit)
+ *  - sleep:      cycles in sleep mode (8 bit)
+ *  - lsu:        additional cycles of load and store instructions (8 bit)
+ *  - fold:       instructions that were folded, i.e. took 0 cycles (8 bit)
+ *
+ * The executed instructions are cycles - cpi - exceptions - sleep - lsu + fold.
+ *
+ * A region is measured with two snapshots:
+ *
+ *     struct perf_counters start, end, diff;
+ *     perf_read(&start);
+ *     ...
+ *     perf_read(&end);
+ *     perf_diff(&start, &end, &diff);
+ *
+ * The 8 bit counters wrap around after 256 events and the DWT has no overflow interrupt.
+ * Every counter counts at most one event per cycle, so a difference is exact
+ * if the region takes less than 256 cycles; `perf_diff` returns if this is the case.
+ * Longer regions are measured with an accumulator that extends the counters to 32 bits.
+ * `perf_accumulate` must be called at least every 256 cycles, e.g. in every iteration of a loop;
+ * intervals that were longer are counted in `overflows`.
+ * Reading the counters takes 6 loads, which are counted as well.
+ */
+
+#ifndef RUNTIME_PERF_H
+#define RUNTIME_PERF_H
+
+#include <stdint.h>
+#include <stm32f1xx.h>
+
+struct perf_counters {
+    uint32_t cycles;
+    uint32_t cpi;
+    uint32_t exceptions;
+    uint32_t sleep;
+    uint32_t lsu;
+    uint32_t fold;
+};
+
+struct perf_accumulator {
+    struct perf_counters last;
+    struct perf_counters total;
+    unsigned overflows;
+};
+
+/*
+ * Enables and resets all counters.
+ */
+void perf_enable();
+
+/*
+ * Takes a snapshot of all counters.
+ */
+static inline void perf_read(struct perf_counters * counters) {
+    counters->cycles = DWT->CYCCNT;
+    counters->cpi = DWT->CPICNT;
+    counters->exceptions = DWT->EXCCNT;
+    counters->sleep = DWT->SLEEPCNT;
+    counters->lsu = DWT->LSUCNT;
+    counters->fold = DWT->FOLDCNT;
+}
+
+/*
+ * Difference of two snapshots. It returns 1 if it is exact, i.e. no 8 bit counter can have wrapped.
+ */
+int perf_diff(const struct perf_counters * start, const struct perf_counters * end, struct perf_counters * diff);
+
+/*
+ * Executed instructions of a difference
+ */
+static inline uint32_t perf_instructions(const struct perf_counters * diff) {
+    return diff->cycles - diff->cpi - diff->exceptions - diff->sleep - diff->lsu + diff->fold;
+}
+
+/*
+ * Starts accumulating from the current counters.
+ */
+void perf_start(struct perf_accumulator * self);
+
+/*
+ * Adds the events since the last call to the totals.
+ */
+void perf_accumulate(struct perf_accumulator * self);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Implementation of the sampling profiler
+ */
+
+#include "profile.h"
+
+#ifdef PROFILE
+
+#ifdef VECTOR_TABLE_INSTRUMENTED
+#error "PROFILE does not work with VECTOR_TABLE_INSTRUMENTED"
+#endif
+
+#include <stm32f1xx.h>
+#include "system.h"
+
+/*
+ * Zero initialized in .bss: An initializer would put the histogram into .data,
+ * i.e. into the flash and the copy at startup.
+ */
+struct profile profile;
+
+/*
+ * Timer 1 is clocked by APB2 which runs with the core clock.
+ * The prescaler is chosen so that the period fits into 16 bits.
+ */
+void profile_start(unsigned frequency) {
+    uint32_t ticks = system_core_clock / frequency;
+    uint32_t prescaler = ticks / 0x10000 + 1;
+
+    profile.bin_shift = PROFILE_BIN_SHIFT;
+    RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+    TIM1->PSC = prescaler - 1;
+    TIM1->ARR = ticks / prescaler - 1;
+    TIM1->EGR = TIM_EGR_UG;
+    TIM1->SR = ~TIM_SR_UIF;
+    TIM1->DIER |= TIM_DIER_UIE;
+    NVIC_SetPriority(TIM1_UP_IRQn, 0);
+    NVIC_EnableIRQ(TIM1_UP_IRQn);
+    TIM1->CR1 |= TIM_CR1_CEN;
+}
+
+void profile_stop() {
+    TIM1->CR1 &= ~TIM_CR1_CEN;
+    NVIC_DisableIRQ(TIM1_UP_IRQn);
+}
+
+/*
+ * Counts the program counter of the exception stack frame
+ * (r0, r1, r2, r3, r12, lr, pc, xpsr).
+ * It is only called from assembler, `used` keeps it with link time optimization.
+ */
+__attribute__ ((used)) void profile_sample(const uint32_t * frame) {
+    TIM1->SR = ~TIM_SR_UIF;
+    uint32_t offset = frame[6] - FLASH_BASE;
+    profile.samples++;
+    if (offset < (PROFILE_BINS << PROFILE_BIN_SHIFT)) {
+        uint16_t * bin = &profile.bins[offset >> PROFILE_BIN_SHIFT];
+        if (*bin != UINT16_MAX) (*bin)++;
+    } else {
+        profile.other++;
+    }
+}
+
+/*
+ * The handler passes the stack frame of the interrupted code,
+ * which is on the main or the process stack, to profile_sample.
+ */
+__attribute__ ((naked)) void on_timer1_up() {
+    __asm volatile (
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b profile_sample\n"
+    );
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * profile is a statistical profiler that samples the program counter.
+ *
+ * The update interrupt of timer 1 interrupts the program at a prime frequency,
+ * so the samples do not lock to the beat. The handler takes the program counter
+ * of the interrupted code from the exception stack frame and counts it
+ * in a histogram of the flash memory with bins of 1 << PROFILE_BIN_SHIFT bytes.
+ *
+ * The sampling interrupt has the highest priority (0).
+ * Handlers with the same priority are not sampled, so give the other interrupts priority 1 or lower.
+ * It does not work together with the instrumented vector table,
+ * because the wrapper changes the stack frame of the handlers.
+ *
+ * With PROFILE defined the framework starts the profiler after `init`.
+ * `tools/profile_report.py` maps a dump of `profile` to the functions of the ELF file.
+ */
+
+#ifndef RUNTIME_PROFILE_H
+#define RUNTIME_PROFILE_H
+
+#include <stdint.h>
+
+#ifndef PROFILE_FREQUENCY
+#define PROFILE_FREQUENCY 997
+#endif
+
+#ifndef PROFILE_BIN_SHIFT
+#define PROFILE_BIN_SHIFT 6
+#endif
+
+/*
+ * The bins cover the 64K of flash
+ */
+#define PROFILE_BINS ((64 * 1024) >> PROFILE_BIN_SHIFT)
+
+struct profile {
+    uint32_t bin_shift;
+    uint32_t samples;
+    uint32_t other;         /* samples outside of the flash */
+    uint16_t bins[PROFILE_BINS];
+};
+
+extern struct profile profile;
+
+/*
+ * Starts sampling with frequency in Hz.
+ */
+void profile_start(unsigned frequency);
+
+/*
+ * Stops sampling.
+ */
+void profile_stop();
+
+#endif
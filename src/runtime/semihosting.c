@@ -0,0 +1,32 @@
+/*
+ * Implementation of the semihosting calls
+ */
+
+#include "semihosting.h"
+#include <stdint.h>
+
+#define SYS_WRITE0 0x04
+#define SYS_EXIT   0x18
+
+/*
+ * Reasons of SYS_EXIT: The host exits with status 0 only for ApplicationExit.
+ */
+#define ADP_STOPPED_APPLICATION_EXIT   0x20026
+#define ADP_STOPPED_RUN_TIME_ERROR     0x20023
+
+static int semihosting_call(int operation, const void * argument) {
+    register int r0 __asm ("r0") = operation;
+    register const void * r1 __asm ("r1") = argument;
+    __asm volatile ("bkpt 0xAB" : "+r" (r0) : "r" (r1) : "memory");
+    return r0;
+}
+
+void semihosting_write(const char * text) {
+    semihosting_call(SYS_WRITE0, text);
+}
+
+void semihosting_exit(int status) {
+    int reason = status == 0 ? ADP_STOPPED_APPLICATION_EXIT : ADP_STOPPED_RUN_TIME_ERROR;
+    semihosting_call(SYS_EXIT, (const void *) (uintptr_t) reason);
+    while (1);
+}
@@ -0,0 +1,23 @@
+/*
+ * semihosting lets a program use the console and the exit status of the debugger or emulator
+ * (e.g. QEMU with -semihosting-config enable=on).
+ *
+ * The calls are breakpoints that are handled by the host.
+ * Without a debugger or emulator attached they end in the hard fault handler,
+ * so they must only be used by test programs.
+ */
+
+#ifndef RUNTIME_SEMIHOSTING_H
+#define RUNTIME_SEMIHOSTING_H
+
+/*
+ * Writes a zero terminated text to the console of the host.
+ */
+void semihosting_write(const char * text);
+
+/*
+ * Ends the program: status 0 is success, everything else failure.
+ */
+void semihosting_exit(int status) __attribute__ ((noreturn));
+
+#endif
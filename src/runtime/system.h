@@ -29,7 +29,8 @@ extern uint32_t system_apb1_clock;
 void system_core_clock_update();
 
 /*
- * Configuration of system ticks
+ * Configuration of system ticks.
+ * The priority of the SysTick interrupt is kept (e.g. the one of the board's priority table).
  */
 void system_tick_config(uint32_t ticks);
 
@@ -38,6 +39,11 @@ void system_tick_config(uint32_t ticks);
  */
 void system_wait_for_event();
 
+/*
+ * Enables the cycle counter of the DWT
+ */
+void system_cycle_counter_enable();
+
 /*
  * Possible clock frequencies
  */
@@ -0,0 +1,31 @@
+/*
+ * Implementation of the trace recorder
+ */
+
+#include "trace.h"
+
+#ifdef TRACE
+
+#include <stm32f1xx.h>
+
+struct trace_buffer trace_buffer;
+
+static inline void trace_write(uint32_t word) {
+    trace_buffer.words[trace_buffer.head++ & (TRACE_SIZE - 1)] = word;
+}
+
+void trace_record(enum trace_event event, unsigned data) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t now = DWT->CYCCNT;
+    uint32_t delta = now - trace_buffer.last;
+    trace_buffer.last = now;
+    if (delta >> TRACE_DELTA_BITS) {
+        trace_write(TRACE_WORD(delta >> TRACE_DELTA_BITS, TRACE_TIME, 0));
+        delta &= (1 << TRACE_DELTA_BITS) - 1;
+    }
+    trace_write(TRACE_WORD(delta, event, data));
+    __set_PRIMASK(primask);
+}
+
+#endif
@@ -2,6 +2,9 @@
  * Vector table for a STM32/Cortex-M3 processor.
  */
 
+#include "vector_table.h"
+#include "trace.h"
+
 /*
  * Top of the stack address has to be provided by the linker.
  * It is defined in the linker script file.
@@ -80,10 +83,40 @@ void on_ext_int15_10()    __attribute__ ((weak, alias("default_handler")));
 void on_rtc_alarm()       __attribute__ ((weak, alias("default_handler")));
 void on_usb_wakeup()      __attribute__ ((weak, alias("default_handler")));
 
+#if defined(VECTOR_TABLE_INSTRUMENTED) || defined(VECTOR_TABLE_RAM)
+#include <stm32f1xx.h>
+#endif
+
+/*
+ * The code does not reference the vector table: The linker script keeps its section
+ * and `used` keeps it when the firmware is linked with link time optimization.
+ */
+#define VECTOR_TABLE_SECTION __attribute__ ((used, section (".vector_table")))
+
+#ifdef VECTOR_TABLE_INSTRUMENTED
+
+static void vector_instrumented();
+
+/*
+ * Every vector except reset, NMI and hard fault calls the wrapper.
+ * NMI and hard fault can not be masked and would break the bookkeeping.
+ * The handlers are taken from the vector_handlers table.
+ */
+VECTOR_TABLE_SECTION const void * const vector_table[VECTOR_TABLE_SIZE] = {
+    [4 ... VECTOR_TABLE_SIZE - 1] = vector_instrumented,
+    [0] = &_stack,
+    [1] = on_reset,
+    [2] = on_nmi,
+    [3] = on_hard_fault
+};
+
+static const void * const vector_handlers[VECTOR_TABLE_SIZE] = {
+#else
 /*
  * Definition of the address vector.
  */
-const void * const vector_table[] = {
+VECTOR_TABLE_SECTION const void * const vector_table[VECTOR_TABLE_SIZE] = {
+#endif
     &_stack,
     on_reset,
     on_nmi,
@@ -144,3 +177,83 @@ const void * const vector_table[] = {
     on_rtc_alarm,
     on_usb_wakeup
 };
+
+#ifdef VECTOR_TABLE_RAM
+
+/*
+ * The processor requires the table to be aligned to its size rounded up to a power of 2.
+ */
+static const void * vector_table_ram[VECTOR_TABLE_SIZE] __attribute__ ((aligned(256)));
+
+/*
+ * The instrumentation wrapper calls the installed handlers.
+ */
+#define VECTOR_HANDLERS vector_table_ram
+
+void vector_table_init() {
+#ifdef VECTOR_TABLE_INSTRUMENTED
+    for (unsigned i = 0; i < VECTOR_TABLE_SIZE; i++) vector_table_ram[i] = vector_handlers[i];
+#else
+    for (unsigned i = 0; i < VECTOR_TABLE_SIZE; i++) vector_table_ram[i] = vector_table[i];
+    SCB->VTOR = (uint32_t) vector_table_ram;
+    __DSB();
+#endif
+}
+
+void vector_install(int irq, vector_handler handler) {
+    vector_table_ram[16 + irq] = handler;
+    __DSB();
+}
+
+#endif
+
+#ifdef VECTOR_TABLE_INSTRUMENTED
+
+#ifndef VECTOR_HANDLERS
+#define VECTOR_HANDLERS vector_handlers
+#endif
+
+struct vector_statistics vector_statistics[VECTOR_TABLE_SIZE];
+unsigned vector_nesting;
+unsigned vector_max_nesting;
+
+/*
+ * Cycles of the handlers that preempted the current handler
+ */
+static uint32_t nested_cycles;
+
+/*
+ * Calls the handler of the active exception and records its statistics.
+ */
+static void vector_instrumented() {
+    unsigned vector = __get_IPSR();
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    uint32_t outer_cycles = nested_cycles;
+    nested_cycles = 0;
+    if (++vector_nesting > vector_max_nesting) vector_max_nesting = vector_nesting;
+    uint32_t entry = DWT->CYCCNT;
+    __set_PRIMASK(primask);
+
+    trace_record(TRACE_IRQ_ENTER, vector);
+    ((void (*)()) VECTOR_HANDLERS[vector])();
+    trace_record(TRACE_IRQ_EXIT, vector);
+
+    __disable_irq();
+    uint32_t exit = DWT->CYCCNT;
+    uint32_t cycles = exit - entry;
+    uint32_t own_cycles = cycles - nested_cycles;
+    nested_cycles = outer_cycles + cycles;
+    vector_nesting--;
+
+    struct vector_statistics * statistics = &vector_statistics[vector];
+    statistics->count++;
+    statistics->entry = entry;
+    statistics->exit = exit;
+    statistics->cycles += own_cycles;
+    if (own_cycles > statistics->max_cycles) statistics->max_cycles = own_cycles;
+    __set_PRIMASK(primask);
+}
+
+#endif
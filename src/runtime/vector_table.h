@@ -0,0 +1,87 @@
+/*
+ * vector_table provides the exception and interrupt vectors of the processor.
+ *
+ * Handlers are bound at link time: An application defines a function with the
+ * name of the vector, e.g. `on_timer4`, which replaces the weak default handler.
+ *
+ * With VECTOR_TABLE_INSTRUMENTED defined every exception and interrupt except
+ * reset, NMI and hard fault enters its handler through a common wrapper
+ * that records statistics per vector with the DWT cycle counter:
+ *
+ *  - count:      number of calls
+ *  - entry/exit: cycle stamps of the last call
+ *  - cycles:     sum of cycles spent in the handler itself
+ *  - max_cycles: longest call
+ *
+ * The cycles of a handler do not include the cycles of handlers preempting it.
+ * The wrapper has no loops: It adds about 25 cycles to the latency of an interrupt
+ * and about 50 cycles to each call, which are not included in the statistics.
+ * The bookkeeping runs with interrupts disabled for at most about 20 cycles.
+ *
+ * With TRACE defined the wrapper also records the entry and exit of the handlers (see trace.h).
+ *
+ * The instrumentation is compiled out by default.
+ *
+ * With VECTOR_TABLE_RAM defined the vectors are copied into RAM at startup
+ * and handlers can be installed at runtime with `vector_install`:
+ *
+ *     vector_install(TIM2_IRQn, on_encoder_capture);
+ *
+ * The handler is entered directly by the processor without any dispatching.
+ * The RAM table takes 256 bytes (it has to be aligned to its size rounded up to a power of 2).
+ * Together with VECTOR_TABLE_INSTRUMENTED only the handlers called by the wrapper are copied
+ * and the processor keeps using the table in flash.
+ */
+
+#ifndef RUNTIME_VECTOR_TABLE_H
+#define RUNTIME_VECTOR_TABLE_H
+
+#include <stdint.h>
+
+/*
+ * 16 exceptions of the Cortex-M3 and 43 interrupts of the STM32F103
+ */
+#define VECTOR_TABLE_SIZE 59
+
+extern const void * const vector_table[VECTOR_TABLE_SIZE];
+
+#ifdef VECTOR_TABLE_RAM
+
+typedef void (* vector_handler)();
+
+/*
+ * Copies the vectors to RAM and relocates the vector table. It is called on startup.
+ */
+void vector_table_init();
+
+/*
+ * Installs handler for irq, the CMSIS interrupt number (IRQn_Type).
+ */
+void vector_install(int irq, vector_handler handler);
+
+#endif
+
+#ifdef VECTOR_TABLE_INSTRUMENTED
+
+struct vector_statistics {
+    uint32_t count;
+    uint32_t entry;
+    uint32_t exit;
+    uint32_t cycles;
+    uint32_t max_cycles;
+};
+
+/*
+ * Statistics indexed by exception number, i.e. 16 + IRQn
+ */
+extern struct vector_statistics vector_statistics[VECTOR_TABLE_SIZE];
+
+/*
+ * Current and deepest nesting of handlers
+ */
+extern unsigned vector_nesting;
+extern unsigned vector_max_nesting;
+
+#endif
+
+#endif
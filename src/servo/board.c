@@ -4,6 +4,10 @@
 
 #include "board.h"
 #include "framework/hooks.h"
+#include "framework/debounce.h"
+#include "framework/inputs.h"
+#include "framework/outputs.h"
+#include "runtime/irq.h"
 #include <stm32f1xx.h>
 
 #define PIN0  (1 << 0)
@@ -16,6 +20,19 @@
 
 #define SERVO_MID_DUTY 1500
 
+/*
+ * The switch is debounced at the beat rate of 50 Hz:
+ * A level must be stable for 4 beats (80 ms).
+ */
+static struct debounce switches;
+
+/*
+ * Priorities of all interrupts of the application
+ */
+static const struct irq_priority irq_priority_table[] = {
+    { TIM4_IRQn, 2 },       /* beat */
+};
+
 /*
  * Setup the board peripherals.
  */
@@ -67,6 +84,8 @@ void setup()  {
 
     /* Configure input pins as pull-up */
     GPIOA->ODR = PIN3 | PIN5;
+    debounce_init(&switches, PIN3 | PIN5);
+    input_config(1 << INPUT_PORT_A, 0);
 
     /*
      * On Port B
@@ -98,9 +117,11 @@ void setup()  {
 
     /*
      * Timer 4 Channel 4 on PB9 configuration:
-     * Initialize PWM mode and enable the channel
+     * Initialize PWM mode and enable the channel.
+     * The update event of timer 4 is the beat of the application.
+     * With the preload enabled a new pulse width takes effect at the next period.
      */
-    TIM4->CCMR2 |= TIM_CCMR2_OC4M_2 | TIM_CCMR2_OC4M_1;
+    TIM4->CCMR2 |= TIM_CCMR2_OC4M_2 | TIM_CCMR2_OC4M_1 | TIM_CCMR2_OC4PE;
     TIM4->CCER  |= TIM_CCER_CC4E;
 
     /*
@@ -112,34 +133,36 @@ void setup()  {
 
     /* Enable the counter */
     TIM4->CR1 |= TIM_CR1_CEN;
+
+    irq_priorities(irq_priority_table, sizeof(irq_priority_table) / sizeof(irq_priority_table[0]));
 }
 
 void moving_led_on() {
-    GPIOC->BRR = PIN13;
+    output_clear(OUTPUT_PORT_C, PIN13);
 }
 
 void moving_led_off() {
-    GPIOC->BSRR = PIN13;
+    output_set(OUTPUT_PORT_C, PIN13);
 }
 
 void position_0_led_on() {
-    GPIOA->BRR = PIN7;
+    output_clear(OUTPUT_PORT_A, PIN7);
 }
 
 void position_0_led_off() {
-    GPIOA->BSRR = PIN7;
+    output_set(OUTPUT_PORT_A, PIN7);
 }
 
 void position_1_led_on() {
-    GPIOA->BRR = PIN0;
+    output_clear(OUTPUT_PORT_A, PIN0);
 }
 
 void position_1_led_off() {
-    GPIOA->BSRR = PIN0;
+    output_set(OUTPUT_PORT_A, PIN0);
 }
 
 int switch_position() {
-    uint16_t input = GPIOA->IDR;
+    uint32_t input = debounce_update(&switches, input_port(INPUT_PORT_A));
     uint16_t pin3 = input & PIN3;
     uint16_t pin5 = input & PIN5;
     if ( pin3 && !pin5) return 1;
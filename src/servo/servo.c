@@ -7,26 +7,33 @@
 
 #include "board.h"
 #include "framework/hooks.h"
+#include "control/motion.h"
+#include "runtime/log.h"
 
 static struct servo {
     int current_position;
     int target_position;
     int end_position[2];
-    int speed;
+    struct motion motion;
 } servo;
 
-void servo_init(struct servo * self, int pos0, int pos1) {
+void servo_init(struct servo * self, int pos0, int pos1, const struct motion_limits * limits) {
     self->current_position = 0;
     self->target_position = 0;
     self->end_position[0] = pos0;
     self->end_position[1] = pos1;
-    self->speed = 1;
+    motion_init(&self->motion, limits, 0);
 }
 
+/*
+ * A new target is taken over when the servo has finished its current move.
+ */
 void servo_control(struct servo * self) {
-    if (self->target_position > self->current_position) self->current_position += self->speed;
-    if (self->target_position < self->current_position) self->current_position -= self->speed;
-    //self->current_position = self->target_position;
+    if (!motion_moving(&self->motion) && self->target_position != self->current_position) {
+        LOG("move from %d to %d", self->current_position, self->target_position);
+        motion_move(&self->motion, self->target_position);
+    }
+    self->current_position = motion_step(&self->motion);
 }
 
 static void update_leds(struct servo * servo) {
@@ -45,13 +52,25 @@ static void update_leds(struct servo * servo) {
     }
 }
 
-#define BEATS_PER_SECOND 2000
+/*
+ * The beat is the period of the servo signal (20 ms), so every step sets one pulse.
+ */
+#define BEATS_PER_SECOND 50
 
 #define END_POSITION_0  900
 #define END_POSITION_1 -900
 
+/*
+ * Limits of the servo movement in µs pulse width per second
+ */
+#define MAX_VELOCITY      3000
+#define MAX_ACCELERATION 20000
+#define MAX_JERK        400000
+
 unsigned init() {
-    servo_init(&servo, END_POSITION_0, END_POSITION_1);
+    struct motion_limits limits;
+    motion_limits_init(&limits, BEATS_PER_SECOND, MAX_VELOCITY, MAX_ACCELERATION, MAX_JERK);
+    servo_init(&servo, END_POSITION_0, END_POSITION_1, &limits);
     return BEATS_PER_SECOND;
 }
 
@@ -0,0 +1,166 @@
+#
+# Functions to build the firmware for STM32 microcontrollers
+#
+# The runtime and the framework are compiled once per device as static libraries
+# (runtime-<device>, framework-<device>). An application only compiles its own sources:
+#
+#   add_stm32_firmware(<name>.elf
+#       SOURCES <sources>...
+#       [DEVICE <device>]                   CMSIS device, default STM32F103xB
+#       [FLASH <size>] [RAM <size>]         memory sizes, default 64K and 20K
+#       [STACK <size>]                      stack size, default 4K
+#       [LINKER_SCRIPT <script>]            instead of a script generated from FLASH and RAM
+#       [DEFINITIONS <definitions>...]      compile definitions of the sources
+#       [FRAMEWORK]                         link the framework (main loop, inputs, outputs)
+#       [FRAMEWORK_DEFINITIONS <definitions>...]
+#                                           framework compiled for this firmware only, e.g. BEAT_TIMER
+#   )
+#
+# Besides the ELF file it generates <name>.bin and <name>.hex and prints the size.
+# The memory usage is reported from the map file <name>.map and checked against
+# the budget in memory-budget.json (see tools/memory_report.py), which fails the build
+# if the firmware grew too much or has no budget. The target memory-budget records the current usage as budget.
+#
+
+set(STM32_RUNTIME_SOURCES
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/cstart.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/vector_table.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/vector_table.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/trace.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/trace.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/system.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/system.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/memory.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/memory.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/irq.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/irq.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/log.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/log.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/perf.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/perf.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/profile.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/profile.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/semihosting.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/runtime/semihosting.c
+)
+
+set(STM32_FRAMEWORK_SOURCES
+    ${CMAKE_CURRENT_LIST_DIR}/src/framework/hooks.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/framework/main.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/framework/inputs.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/framework/inputs.c
+    ${CMAKE_CURRENT_LIST_DIR}/src/framework/outputs.h
+    ${CMAKE_CURRENT_LIST_DIR}/src/framework/outputs.c
+)
+
+# The compiler emits calls of memcpy and memset after link time optimization,
+# so their definitions must be in a normal object file.
+set_source_files_properties(${CMAKE_CURRENT_LIST_DIR}/src/runtime/memory.c PROPERTIES COMPILE_OPTIONS -fno-lto)
+
+set(STM32_LINKER_SCRIPT_TEMPLATE ${CMAKE_CURRENT_LIST_DIR}/src/runtime/arm-gcc.ld.in)
+set(STM32_LINKER_SCRIPT_DIR ${CMAKE_CURRENT_LIST_DIR}/src/runtime)
+
+find_package(Python3 COMPONENTS Interpreter)
+set(STM32_MEMORY_REPORT ${CMAKE_CURRENT_LIST_DIR}/tools/memory_report.py)
+set(STM32_MEMORY_BUDGET ${CMAKE_CURRENT_LIST_DIR}/memory-budget.json)
+if(Python3_FOUND)
+    add_custom_target(memory-budget)
+else()
+    message(WARNING "Python 3 not found: the memory usage is neither reported nor checked against ${STM32_MEMORY_BUDGET}")
+endif()
+
+function(add_stm32_firmware name)
+    cmake_parse_arguments(PARSE_ARGV 1 FIRMWARE
+        "FRAMEWORK"
+        "DEVICE;FLASH;RAM;STACK;LINKER_SCRIPT"
+        "SOURCES;DEFINITIONS;FRAMEWORK_DEFINITIONS"
+    )
+    if(NOT FIRMWARE_DEVICE)
+        set(FIRMWARE_DEVICE STM32F103xB)
+    endif()
+    if(NOT FIRMWARE_FLASH)
+        set(FIRMWARE_FLASH 64K)
+    endif()
+    if(NOT FIRMWARE_RAM)
+        set(FIRMWARE_RAM 20K)
+    endif()
+    if(NOT FIRMWARE_STACK)
+        set(FIRMWARE_STACK 4K)
+    endif()
+
+    set(runtime runtime-${FIRMWARE_DEVICE})
+    if(NOT TARGET ${runtime})
+        add_library(${runtime} STATIC ${STM32_RUNTIME_SOURCES})
+        target_compile_definitions(${runtime} PUBLIC ${FIRMWARE_DEVICE})
+    endif()
+
+    get_filename_component(base ${name} NAME_WE)
+    if(NOT FIRMWARE_LINKER_SCRIPT)
+        set(FIRMWARE_LINKER_SCRIPT ${CMAKE_CURRENT_BINARY_DIR}/${base}.ld)
+        configure_file(${STM32_LINKER_SCRIPT_TEMPLATE} ${FIRMWARE_LINKER_SCRIPT} @ONLY)
+    endif()
+
+    add_executable(${name} ${FIRMWARE_SOURCES})
+    target_compile_definitions(${name} PRIVATE ${FIRMWARE_DEFINITIONS})
+
+    #
+    # The whole runtime is linked: The handlers of cstart and profile replace
+    # the weak handlers of the vector table, which an archive member never does.
+    # --gc-sections removes what is not used.
+    #
+    target_link_libraries(${name} PRIVATE -Wl,--whole-archive ${runtime} -Wl,--no-whole-archive)
+
+    if(FIRMWARE_FRAMEWORK_DEFINITIONS)
+        set(framework ${base}-framework)
+        add_library(${framework} STATIC ${STM32_FRAMEWORK_SOURCES})
+        target_compile_definitions(${framework} PRIVATE ${FIRMWARE_FRAMEWORK_DEFINITIONS})
+        target_link_libraries(${framework} PUBLIC ${runtime})
+        target_link_libraries(${name} PRIVATE ${framework})
+    elseif(FIRMWARE_FRAMEWORK)
+        set(framework framework-${FIRMWARE_DEVICE})
+        if(NOT TARGET ${framework})
+            add_library(${framework} STATIC ${STM32_FRAMEWORK_SOURCES})
+            target_link_libraries(${framework} PUBLIC ${runtime})
+        endif()
+        target_link_libraries(${name} PRIVATE ${framework})
+    else()
+        target_link_libraries(${name} PRIVATE ${runtime})
+    endif()
+
+    target_link_options(${name} PRIVATE
+        -specs=nosys.specs # use libnosys as libc
+        -nostartfiles
+        -L ${STM32_LINKER_SCRIPT_DIR} # the linker scripts include sections.ld
+        -T ${FIRMWARE_LINKER_SCRIPT}
+        -Wl,-Map=${CMAKE_CURRENT_BINARY_DIR}/${base}.map
+    )
+    set_target_properties(${name} PROPERTIES LINK_DEPENDS ${FIRMWARE_LINKER_SCRIPT})
+
+    add_custom_command(TARGET ${name} POST_BUILD
+        COMMAND ${CMAKE_OBJCOPY} -O binary $<TARGET_FILE:${name}> ${base}.bin
+        COMMAND ${CMAKE_OBJCOPY} -O ihex $<TARGET_FILE:${name}> ${base}.hex
+        COMMAND ${CMAKE_SIZE} $<TARGET_FILE:${name}>
+        BYPRODUCTS ${base}.bin ${base}.hex
+        WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+    )
+
+    #
+    # The report is only written if the check passes, so a failed check is repeated by the next build.
+    #
+    if(Python3_FOUND)
+        add_custom_command(OUTPUT ${base}.memory
+            COMMAND ${Python3_EXECUTABLE} ${STM32_MEMORY_REPORT} ${base}.map
+                    --budget ${STM32_MEMORY_BUDGET} --firmware ${base} --output ${base}.memory
+            DEPENDS ${name} ${STM32_MEMORY_BUDGET} ${STM32_MEMORY_REPORT}
+            WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+        )
+        add_custom_target(${base}-memory ALL DEPENDS ${base}.memory)
+
+        add_custom_command(TARGET memory-budget POST_BUILD
+            COMMAND ${Python3_EXECUTABLE} ${STM32_MEMORY_REPORT} ${base}.map
+                    --budget ${STM32_MEMORY_BUDGET} --firmware ${base} --update
+            WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+        )
+        add_dependencies(memory-budget ${name})
+    endif()
+endfunction()
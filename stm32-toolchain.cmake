@@ -6,12 +6,14 @@ set(CMAKE_SYSTEM_PROCESSOR arm)
 #
 set(CMAKE_C_COMPILER arm-none-eabi-gcc)
 
-set(CMAKE_C_FLAGS "-mcpu=cortex-m3 -mthumb -mfloat-abi=soft -ffunction-sections -fdata-sections")
+set(CMAKE_C_FLAGS "-mcpu=cortex-m3 -mthumb -mfloat-abi=soft -ffunction-sections -fdata-sections -flto")
 #  -mcpu=cortex-m3      Specify the name of the target CPU
 #  -mfloat-abi=soft     Specify if floating point hardware should be used.
 #  -mthumb              Generate code for Thumb state.
 #  -ffunction-sections  Place each function
 #  -fdata-sections      or data item in its own section
+#  -flto                Link time optimization: the compiler flags are passed to the link as well,
+#                       so the whole firmware is optimized as one unit (e.g. the board functions are inlined into `step`)
 
 set(CMAKE_C_FLAGS_DEBUG "-g3 -O0 -DDEBUG")
 #    -g3                debug information level 3
@@ -31,6 +33,19 @@ set(CMAKE_C_FLAGS_RELWITHDBGINFO "-Og -g3 -DNDEBUG")
 #    -g3                Include debug info
 #    -DNDEBUG           Set NDEBUG
 
+#
+# Archiver: the static libraries contain LTO objects, the wrappers of gcc index their symbols
+#
+set(CMAKE_AR arm-none-eabi-gcc-ar)
+set(CMAKE_RANLIB arm-none-eabi-gcc-ranlib)
+
+#
+# Binary utilities: CMake finds them by the prefix of the compiler only in some versions,
+# otherwise the ones of the host would be used
+#
+set(CMAKE_OBJCOPY arm-none-eabi-objcopy)
+set(CMAKE_SIZE arm-none-eabi-size)
+
 #
 # Assembler
 #
@@ -39,10 +54,9 @@ set(CMAKE_ASM_COMPILER ${CMAKE_C_COMPILER})
 #
 # Linker flags
 #
-set(CMAKE_LDFLAGS "-static -Wl,--gc-sections -flto")
+set(CMAKE_EXE_LINKER_FLAGS_INIT "-static -Wl,--gc-sections")
 #    -static             # force static linking (no shared objects)
-#    --gc-sections        # remove unused sections. Does not work unfortunately...
-#    -flto                # link time optimization
+#    --gc-sections       # remove unused sections, the roots are the KEEP sections of the linker script
 
 set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
 
@@ -0,0 +1,159 @@
+/*
+ * Host test of the motion profile generator.
+ *
+ * Every move is stepped to its end and checked beat by beat against the limits.
+ */
+
+#include "control/motion.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+static int64_t abs64(int64_t x) {
+    return x < 0 ? -x : x;
+}
+
+/*
+ * Runs a move and returns 1 if it stays within the limits and ends exactly at target.
+ * The profile ends at velocity 0, so the position change of the last beat is the correction
+ * of the rounding error, which must be less than a unit.
+ */
+static int move(struct motion * motion, int32_t target) {
+    const struct motion_limits * limits = &motion->limits;
+    if (motion_move(motion, target) != 0) return 0;
+
+    int ok = 1;
+    int64_t acceleration = 0;
+    int64_t previous = 0;
+    for (int beat = 0; motion_moving(motion) && beat < 10000000; beat++) {
+        int64_t position = motion->position;
+        motion_step(motion);
+        int64_t delta = motion->position - position;
+        if (motion_moving(motion)) {
+            ok = ok && abs64(motion->velocity) <= limits->velocity;
+            ok = ok && abs64(motion->acceleration) <= limits->acceleration;
+            if (limits->jerk != 0) ok = ok && abs64(motion->acceleration - acceleration) <= limits->jerk;
+            ok = ok && abs64(delta) <= limits->velocity;
+            ok = ok && abs64(delta - previous) <= limits->acceleration;
+        } else {
+            ok = ok && abs64(delta) < (1LL << MOTION_FRACTION_BITS);
+        }
+        acceleration = motion->acceleration;
+        previous = delta;
+    }
+    ok = ok && !motion_moving(motion);
+    ok = ok && motion->position == (int64_t) target << MOTION_FRACTION_BITS;
+    ok = ok && motion->velocity == 0 && motion->acceleration == 0;
+    return ok && motion_position(motion) == target && motion_step(motion) == target;
+}
+
+static int moves(const struct motion_limits * limits) {
+    static const int32_t targets[] = { 900, -900, -899, -900, 0, 1, 0, -1, 2, 10000, -10000, 0 };
+    struct motion motion;
+    motion_init(&motion, limits, 0);
+    int ok = 1;
+    for (unsigned i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        ok = ok && move(&motion, targets[i]);
+    }
+    return ok;
+}
+
+static void test_s_curve() {
+    struct motion_limits limits;
+    int ok = motion_limits_init(&limits, 50, 3000, 20000, 400000) == 0;
+    check("s-curve", ok && moves(&limits));
+}
+
+static void test_trapezoid() {
+    struct motion_limits limits;
+    int ok = motion_limits_init(&limits, 1000, 5000, 20000, 0) == 0;
+    check("trapezoid", ok && moves(&limits));
+}
+
+static void test_fast_beat() {
+    struct motion_limits limits;
+    struct motion motion;
+    int ok = motion_limits_init(&limits, 10000, 100, 1000, 100000) == 0;
+    ok = ok && moves(&limits);
+    /* the ramps alone nearly reach the target, the integer scale leaves 537 units */
+    ok = ok && motion_limits_init(&limits, 10000, 19354, 182314, 4513) == 0;
+    motion_init(&motion, &limits, 0);
+    check("fast beat", ok && move(&motion, 10240));
+}
+
+/*
+ * Pseudo random numbers (xorshift), the same on every host
+ */
+static uint32_t random_state = 2463534242u;
+
+static uint32_t random_below(uint32_t n) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % n;
+}
+
+static void test_random() {
+    static const unsigned beats_per_second[] = { 50, 1000, 2000, 10000 };
+    int ok = 1;
+    for (int i = 0; i < 1000; i++) {
+        struct motion_limits limits;
+        struct motion motion;
+        unsigned rate = beats_per_second[random_below(4)];
+        int32_t velocity = 100 + random_below(20000);
+        int32_t acceleration = 1 + random_below(200000);
+        int32_t jerk = random_below(5000);
+        if (motion_limits_init(&limits, rate, velocity, acceleration, jerk) != 0) continue;
+        int32_t start = random_below(2001) - 1000;
+        int32_t target = random_below(20001) - 10000;
+        motion_init(&motion, &limits, start);
+        if (!move(&motion, target)) {
+            printf("%u beats/s, v %d, a %d, j %d: move from %d to %d\n",
+                   rate, velocity, acceleration, jerk, start, target);
+            ok = 0;
+        }
+    }
+    check("random limits", ok);
+}
+
+static void test_in_progress() {
+    struct motion_limits limits;
+    struct motion motion;
+    motion_limits_init(&limits, 50, 3000, 20000, 400000);
+    motion_init(&motion, &limits, 0);
+    int ok = motion_move(&motion, 100) == 0;
+    motion_step(&motion);
+    ok = ok && motion_move(&motion, -100) == -1 && motion.target == 100;
+    while (motion_moving(&motion)) motion_step(&motion);
+    check("move in progress", ok && motion_position(&motion) == 100);
+}
+
+static void test_invalid_limits() {
+    struct motion_limits limits;
+    struct motion motion;
+    int ok = motion_limits_init(&limits, 50, 0, 20000, 400000) == -1;
+    ok = ok && motion_limits_init(&limits, 50, 3000, 0, 0) == -1;
+    ok = ok && motion_limits_init(&limits, 50, 3000, 20000, -1) == -1;
+    /* 1 unit/s² is 0 per beat at 100 kHz */
+    ok = ok && motion_limits_init(&limits, 100000, 3000, 1, 0) == -1;
+    motion_init(&motion, &limits, 0);
+    ok = ok && motion_move(&motion, 100) == -1 && !motion_moving(&motion);
+    check("invalid limits", ok && motion_step(&motion) == 0);
+}
+
+int main(int argc, char ** argv) {
+    test_s_curve();
+    test_trapezoid();
+    test_fast_beat();
+    test_random();
+    test_in_progress();
+    test_invalid_limits();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/*
+ * Host test of the PID controller.
+ *
+ * The controller runs in a closed loop with a simulated first order plant.
+ */
+
+#include "control/pid.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+static const struct pid_parameters pi = {
+    .kp = PID_Q16(0.5),
+    .ki = PID_Q16(0.05),
+    .kd = PID_Q16(2.0),
+    .b = PID_Q16(1.0),
+    .c = 0,
+    .filter = PID_Q16(0.5),
+    .min = -500,
+    .max = 500
+};
+
+/*
+ * First order plant with time constant of 8 beats and gain 2
+ */
+static int32_t plant(int32_t y, int32_t u) {
+    return y + (2 * u - y) / 8;
+}
+
+static void test_convergence() {
+    struct pid pid;
+    pid_init(&pid, &pi);
+    pid_automatic(&pid);
+    int32_t y = 0;
+    for (int i = 0; i < 500; i++) {
+        y = plant(y, pid_step(&pid, 400, y));
+    }
+    check("convergence", abs(y - 400) <= 1);
+}
+
+static void test_anti_windup() {
+    struct pid pid;
+    pid_init(&pid, &pi);
+    pid_automatic(&pid);
+    int32_t y = 0;
+    for (int i = 0; i < 2000; i++) {
+        y = plant(y, pid_step(&pid, 5000, y));
+    }
+    int saturated = pid.output == pi.max;
+    int beats = 0;
+    while (pid_step(&pid, 0, y) == pi.max && beats < 100) beats++;
+    check("anti-windup", saturated && beats <= 1);
+}
+
+static void test_bumpless_transfer() {
+    struct pid pid;
+    pid_init(&pid, &pi);
+    pid_manual(&pid, 300);
+    int32_t y = 0;
+    for (int i = 0; i < 100; i++) {
+        y = plant(y, pid_step(&pid, 200, y));
+    }
+    pid_automatic(&pid);
+    int32_t u = pid_step(&pid, 200, y);
+    check("bumpless transfer", abs(u - 300) <= abs(200 - y) / 16 + 1);
+
+    struct pid_parameters tuned = pi;
+    tuned.kp = PID_Q16(3.0);
+    int32_t before = pid_step(&pid, 200, y);
+    pid_tune(&pid, &tuned);
+    int32_t after = pid_step(&pid, 200, y);
+    check("bumpless tuning", abs(after - before) <= abs(200 - y) / 16 + 1);
+}
+
+static void test_setpoint_weighting() {
+    struct pid_parameters weighted = pi;
+    weighted.b = 0;
+    struct pid pid;
+    pid_init(&pid, &weighted);
+    pid_automatic(&pid);
+    int32_t y = 0;
+    for (int i = 0; i < 10; i++) pid_step(&pid, 0, y);
+    int32_t u = pid_step(&pid, 100, y);
+    /* only the integral reacts on a setpoint step: 0.05 * 100 */
+    check("setpoint weighting", u == 5);
+}
+
+static void test_derivative_filter() {
+    struct pid_parameters unfiltered = pi;
+    unfiltered.ki = 0;
+    unfiltered.kp = 0;
+    unfiltered.filter = PID_Q16(1.0);
+    struct pid_parameters filtered = unfiltered;
+    filtered.filter = PID_Q16(0.25);
+
+    struct pid a, b;
+    pid_init(&a, &unfiltered);
+    pid_init(&b, &filtered);
+    pid_automatic(&a);
+    pid_automatic(&b);
+    pid_step(&a, 0, 0);
+    pid_step(&b, 0, 0);
+    int32_t peak_a = pid_step(&a, 0, 100);
+    int32_t peak_b = pid_step(&b, 0, 100);
+    check("derivative filter", peak_a == -200 && peak_b == -50);
+}
+
+static void test_step_all() {
+    struct pid pids[4];
+    struct pid single[4];
+    int32_t setpoints[4] = { 100, -200, 300, 0 };
+    int32_t measurements[4] = { 0, 10, -20, 30 };
+    int32_t outputs[4];
+    for (int i = 0; i < 4; i++) {
+        pid_init(&pids[i], &pi);
+        pid_init(&single[i], &pi);
+        pid_automatic(&pids[i]);
+        pid_automatic(&single[i]);
+    }
+    int equal = 1;
+    for (int beat = 0; beat < 50; beat++) {
+        pid_step_all(pids, setpoints, measurements, outputs, 4);
+        for (int i = 0; i < 4; i++) {
+            equal = equal && outputs[i] == pid_step(&single[i], setpoints[i], measurements[i]);
+            measurements[i] = plant(measurements[i], outputs[i]);
+        }
+    }
+    check("step all", equal);
+}
+
+int main(int argc, char ** argv) {
+    test_convergence();
+    test_anti_windup();
+    test_bumpless_transfer();
+    test_setpoint_weighting();
+    test_derivative_filter();
+    test_step_all();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,34 @@
+/*
+ * Target test of the framework: Every beat executes exactly one step
+ * with the input snapshot of its beat.
+ */
+
+#include "framework/hooks.h"
+#include "framework/inputs.h"
+#include "../runtime/target_test.h"
+
+#define BEATS_PER_SECOND 100
+#define BEATS 10
+
+static unsigned expected_beat;
+static int in_order = 1;
+static int snapshot = 1;
+
+void setup() {
+}
+
+unsigned init() {
+    return BEATS_PER_SECOND;
+}
+
+void step(unsigned beat) {
+    in_order = in_order && beat == expected_beat;
+    snapshot = snapshot && input_current->beat == beat;
+    expected_beat++;
+
+    if (beat == BEATS) {
+        check("steps in order", in_order);
+        check("input snapshot", snapshot);
+        test_exit();
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Host test of the vertical counter debouncing.
+ */
+
+#include "framework/debounce.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+static void test_stable_change() {
+    struct debounce d;
+    debounce_init(&d, 0x0000);
+    int ok = 1;
+    for (int i = 1; i < DEBOUNCE_SAMPLES; i++) {
+        ok = ok && debounce_update(&d, 0x8001) == 0 && debounce_rising(&d) == 0;
+    }
+    ok = ok && debounce_update(&d, 0x8001) == 0x8001 && debounce_rising(&d) == 0x8001;
+    ok = ok && debounce_update(&d, 0x8001) == 0x8001 && debounce_rising(&d) == 0;
+    for (int i = 1; i < DEBOUNCE_SAMPLES; i++) {
+        ok = ok && debounce_update(&d, 0x0001) == 0x8001 && debounce_falling(&d) == 0;
+    }
+    ok = ok && debounce_update(&d, 0x0001) == 0x0001 && debounce_falling(&d) == 0x8000;
+    check("stable change", ok);
+}
+
+static void test_bounce() {
+    struct debounce d;
+    debounce_init(&d, 0xFFFF);
+    int ok = 1;
+    /* a glitch shorter than DEBOUNCE_SAMPLES restarts the counter */
+    for (int i = 0; i < 100; i++) {
+        uint32_t sample = (i % DEBOUNCE_SAMPLES == DEBOUNCE_SAMPLES - 1) ? 0xFFFF : 0xFFF0;
+        ok = ok && debounce_update(&d, sample) == 0xFFFF;
+    }
+    check("bounce", ok);
+}
+
+static void test_independent_bits() {
+    struct debounce d;
+    debounce_init(&d, 0);
+    int ok = 1;
+    for (int i = 0; i < 64; i++) {
+        /* bit n toggles with a period of 2 (n + 1) samples */
+        uint32_t sample = 0;
+        for (int n = 0; n < 16; n++) {
+            if ((i / (n + 1)) & 1) sample |= 1 << n;
+        }
+        debounce_update(&d, sample);
+        /* bits with at least DEBOUNCE_SAMPLES equal samples follow with a delay */
+        for (int n = DEBOUNCE_SAMPLES - 1; n < 16; n++) {
+            int expected = ((i - (DEBOUNCE_SAMPLES - 1)) / (n + 1)) & 1;
+            if (i >= DEBOUNCE_SAMPLES - 1) ok = ok && ((d.state >> n) & 1) == expected;
+        }
+        for (int n = 0; n < DEBOUNCE_SAMPLES - 1; n++) {
+            ok = ok && ((d.state >> n) & 1) == 0;
+        }
+    }
+    check("independent bits", ok);
+}
+
+int main(int argc, char ** argv) {
+    test_stable_change();
+    test_bounce();
+    test_independent_bits();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * Host test of the beat scheduling of the framework main loop.
+ *
+ * The system, the input and the output stage are replaced by mocks that record their calls.
+ * Waiting for an event simulates the beat interrupt,
+ * and the test ends by jumping out of the main loop.
+ */
+
+#include "framework/hooks.h"
+#include "framework/inputs.h"
+#include "framework/outputs.h"
+#include "runtime/system.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int framework_main(int argc, char ** argv);
+void on_sys_tick();
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+#define BEATS_PER_SECOND 1000
+#define BEATS 3
+
+/*
+ * Log of the calls: one letter per call followed by the beat if it has one.
+ */
+static char calls[256];
+
+static void record(const char * call) {
+    strncat(calls, call, sizeof(calls) - strlen(calls) - 1);
+}
+
+static void record_beat(char call, unsigned beat) {
+    char text[16];
+    snprintf(text, sizeof(text), "%c%u ", call, beat);
+    record(text);
+}
+
+static jmp_buf end_of_test;
+static unsigned interrupts;
+static unsigned step_input_beat;
+
+/* mock of the system */
+uint32_t system_core_clock = 8000000;
+static uint32_t tick_period;
+
+void system_core_clock_update() {
+}
+
+void system_tick_config(uint32_t ticks) {
+    tick_period = ticks;
+}
+
+void system_wait_for_event() {
+    if (interrupts++ == BEATS) longjmp(end_of_test, 1);
+    on_sys_tick();
+}
+
+/* mock of the input and output stage */
+static struct input_snapshot snapshot;
+const struct input_snapshot * input_current = &snapshot;
+uint16_t output_shadow[OUTPUT_PORTS];
+
+void input_capture(unsigned beat) {
+    record_beat('I', beat);
+}
+
+void input_select(unsigned beat) {
+    snapshot.beat = beat;
+    record_beat('L', beat);
+}
+
+void output_init() {
+    record("O ");
+}
+
+void output_commit() {
+    record("C ");
+}
+
+/* application */
+void setup() {
+    record("U ");
+}
+
+unsigned init() {
+    record("N ");
+    return BEATS_PER_SECOND;
+}
+
+void step(unsigned beat) {
+    step_input_beat = input_current->beat;
+    record_beat('S', beat);
+}
+
+int main(int argc, char ** argv) {
+    if (setjmp(end_of_test) == 0) framework_main(0, NULL);
+
+    check("tick period", tick_period == system_core_clock / BEATS_PER_SECOND);
+    /*
+     * setup, outputs, init, first snapshot, then per beat:
+     * step, snapshot in the interrupt, commit of the outputs, selection of the snapshot
+     */
+    check("call order", strcmp(calls,
+        "U O N I0 S0 I1 C L1 S1 I2 C L2 S2 I3 C L3 S3 ") == 0);
+    check("step input", step_input_beat == BEATS);
+    if (failures) printf("calls: %s\n", calls);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+/*
+ * Cycle benchmark of the fixed-point library on the target.
+ *
+ * Every function is called BENCH_CALLS times with varying arguments
+ * and the average number of cycles per call is measured with the DWT cycle counter.
+ * A single call is measured with all DWT counters to see if a function is
+ * bound by wait states (cpi) or load and stores (lsu).
+ * The results are stored in `bench_results` which can be inspected with the debugger.
+ * The green LED is switched on when the benchmark has finished.
+ */
+
+#include <stm32f1xx.h>
+#include "math/fixed.h"
+#include "runtime/perf.h"
+#include "runtime/system.h"
+
+#define PIN13 (1 << 13)
+
+#define BENCH_CALLS 1000
+
+struct bench_result {
+    const char * name;
+    uint32_t cycles;
+    struct perf_counters call;
+    uint32_t instructions;
+};
+
+volatile struct bench_result bench_results[12];
+
+/* sink for the results so that the calls are not optimized away */
+volatile int32_t bench_sink;
+
+#define BENCH(index, expression) do {                       \
+        int32_t sink = 0;                                   \
+        uint32_t start = DWT->CYCCNT;                       \
+        for (int32_t i = 0; i < BENCH_CALLS; i++) {         \
+            sink += (expression);                           \
+        }                                                   \
+        uint32_t cycles = DWT->CYCCNT - start;              \
+        struct perf_counters before, after, call;           \
+        int32_t i __attribute__ ((unused)) = BENCH_CALLS / 2; \
+        perf_read(&before);                                 \
+        sink += (expression);                               \
+        perf_read(&after);                                  \
+        perf_diff(&before, &after, &call);                  \
+        bench_sink = sink;                                  \
+        bench_results[index].name = #expression;            \
+        bench_results[index].cycles = cycles / BENCH_CALLS; \
+        bench_results[index].call = call;                   \
+        bench_results[index].instructions = perf_instructions(&call); \
+    } while (0)
+
+int main(int argc, char **argv)  {
+    RCC->APB2ENR |= RCC_APB2ENR_IOPCEN;
+    GPIOC->BSRR = PIN13;
+    GPIOC->CRH = 0x44644444;
+
+    system_clock_frequency(CLOCK_FRQ_72_MHZ);
+
+    perf_enable();
+
+    int exponent;
+    int64_t acc = 0;
+    BENCH(0, 0);
+    BENCH(1, q15_mul(i, 0x1234));
+    BENCH(2, q31_mul(i << 16, 0x12345678));
+    BENCH(3, (int32_t) (acc = q31_mac(acc, i << 16, 0x12345678)));
+    BENCH(4, fixed_reciprocal(i + 1, &exponent));
+    BENCH(5, q31_div(i << 10, 0x40000000));
+    BENCH(6, fixed_sqrt(i << 20));
+    BENCH(7, q15_sqrt(i << 5));
+    BENCH(8, q31_sqrt(i << 21));
+    BENCH(9, q15_sin(i << 6));
+    BENCH(10, q15_cos(i << 6));
+    BENCH(11, fixed_atan2(i << 10, 1000 - i));
+
+    GPIOC->BRR = PIN13;
+    while (1);
+}
@@ -0,0 +1,131 @@
+/*
+ * Host test of the fixed-point library.
+ *
+ * Every function is compared against the double precision result of libm.
+ * The test prints the maximum error of each function
+ * and returns a non zero exit code if an error exceeds its bound.
+ */
+
+#include "math/fixed.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+
+static void check(const char * name, double error, double bound) {
+    int ok = error <= bound;
+    printf("%-18s max error %.3g (bound %.3g) %s\n", name, error, bound, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+static double q15(q15_t x) { return x / 32768.0; }
+static double q31(q31_t x) { return x / 2147483648.0; }
+
+static void test_saturation() {
+    double error = 0;
+    error = fmax(error, fabs(q15_add(Q15_MAX, 1) - Q15_MAX));
+    error = fmax(error, fabs(q15_sub(Q15_MIN, 1) - Q15_MIN));
+    error = fmax(error, fabs(q15_mul(Q15_MIN, Q15_MIN) - Q15_MAX));
+    error = fmax(error, fabs((double) q31_add(Q31_MAX, 1) - Q31_MAX));
+    error = fmax(error, fabs((double) q31_sub(Q31_MIN, 1) - Q31_MIN));
+    error = fmax(error, fabs((double) q31_mul(Q31_MIN, Q31_MIN) - Q31_MAX));
+    check("saturation", error, 0);
+}
+
+static void test_multiply() {
+    double error = 0;
+    int64_t acc = 0;
+    double sum = 0;
+    for (int i = 0; i < 100000; i++) {
+        q31_t a = (q31_t) (rand() * 2U) - (q31_t) RAND_MAX;
+        q31_t b = (q31_t) (rand() * 2U) - (q31_t) RAND_MAX;
+        error = fmax(error, fabs(q31(q31_mul(a, b)) - q31(a) * q31(b)));
+        if (i < 64) {
+            acc = q31_mac(acc, a, b);
+            sum += q31(a) * q31(b);
+        }
+    }
+    check("q31_mul", error, 1.0 / 2147483648.0);
+    check("q31_mac", fabs(q31(q31_mac_result(acc)) - fmax(-1, fmin(1, sum))), 1.0 / 2147483648.0);
+}
+
+static void test_reciprocal() {
+    double error = 0;
+    for (uint32_t x = 1; x < 0xFFFF0000U; x += x / 97 + 1) {
+        int exponent;
+        q31_t m = fixed_reciprocal(x, &exponent);
+        double r = ldexp(q31(m), -exponent);
+        error = fmax(error, fabs(r * x - 1));
+    }
+    check("fixed_reciprocal", error, ldexp(1, -29));
+
+    error = 0;
+    for (int i = 0; i < 100000; i++) {
+        q31_t d = rand() - RAND_MAX / 2;
+        q31_t n = (q31_t) ((int64_t) d * (rand() % 2001 - 1000) / 1000);
+        if (d == 0) continue;
+        double expected = fmax(-1, fmin(1, (double) n / d));
+        error = fmax(error, fabs(q31(q31_div(n, d)) - expected));
+    }
+    check("q31_div", error, ldexp(1, -28));
+}
+
+static void test_sqrt() {
+    double error = 0;
+    for (uint64_t x = 0; x <= UINT32_MAX; x += x / 101 + 1) {
+        uint32_t r = fixed_sqrt((uint32_t) x);
+        error = fmax(error, (uint64_t) r * r > x || (uint64_t) (r + 1) * (r + 1) <= x);
+    }
+    error = fmax(error, fixed_sqrt(UINT32_MAX) != 0xFFFF);
+    check("fixed_sqrt", error, 0);
+
+    error = 0;
+    for (int x = 0; x <= Q15_MAX; x++) {
+        error = fmax(error, fabs(q15(q15_sqrt(x)) - sqrt(q15(x))));
+    }
+    check("q15_sqrt", error, 1.0 / 32768.0);
+
+    error = 0;
+    for (uint32_t x = 1; x <= Q31_MAX; x += x / 89 + 1) {
+        error = fmax(error, fabs(q31(q31_sqrt(x)) - sqrt(q31(x))));
+    }
+    check("q31_sqrt", error, ldexp(1, -28));
+}
+
+static void test_trigonometry() {
+    double error_sin = 0;
+    double error_cos = 0;
+    for (int angle = 0; angle < ANGLE_TURN; angle++) {
+        double phi = angle * 2 * M_PI / ANGLE_TURN;
+        error_sin = fmax(error_sin, fabs(q15(q15_sin(angle)) - sin(phi)));
+        error_cos = fmax(error_cos, fabs(q15(q15_cos(angle)) - cos(phi)));
+    }
+    check("q15_sin", error_sin, 2.0 / 32768.0);
+    check("q15_cos", error_cos, 2.0 / 32768.0);
+
+    double error = 0;
+    for (int i = 0; i < 100000; i++) {
+        int32_t y = rand() - RAND_MAX / 2;
+        int32_t x = rand() - RAND_MAX / 2;
+        if (i & 1) {
+            y >>= rand() % 30;
+            x >>= rand() % 30;
+        }
+        if (x == 0 && y == 0) continue;
+        double expected = atan2(y, x) * ANGLE_TURN / (2 * M_PI);
+        double difference = fabs(fixed_atan2(y, x) - expected);
+        error = fmax(error, fmin(difference, ANGLE_TURN - difference));
+    }
+    check("fixed_atan2", error, 2);
+}
+
+int main(int argc, char ** argv) {
+    test_saturation();
+    test_multiply();
+    test_reciprocal();
+    test_sqrt();
+    test_trigonometry();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,416 @@
+/*
+ * Implementation of the simulated peripheral registers
+ */
+
+#define _GNU_SOURCE
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "the peripheral mock needs Linux x86-64 (see peripherals.h)"
+#endif
+
+#include "peripherals.h"
+#include "runtime/vector_table.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#define PERIPHERALS_SIZE 0x24000
+#define CORE_BASE        0xE0000000UL
+#define CORE_SIZE        0x100000
+
+#define PAGE_FAULT_WRITE 0x2
+#define TRAP_FLAG        0x100
+
+#define REG(reg) ((uintptr_t) &(reg))
+
+/*
+ * The top of the stack is referenced by the vector table
+ */
+int _stack;
+
+struct region {
+    uintptr_t base;
+    size_t size;
+    uint32_t * reads;
+    uint32_t * writes;
+};
+
+static struct region regions[] = {
+    { PERIPH_BASE, PERIPHERALS_SIZE },
+    { CORE_BASE, CORE_SIZE }
+};
+
+#define REGIONS (sizeof(regions) / sizeof(regions[0]))
+
+struct mock_access mock_trace[MOCK_TRACE_SIZE];
+unsigned mock_accesses;
+uint64_t mock_cycles;
+
+static unsigned interrupts;
+
+/*
+ * Protects (on) or unprotects the registers.
+ */
+static void lock(int on) {
+    for (unsigned i = 0; i < REGIONS; i++) {
+        mprotect((void *) regions[i].base, regions[i].size, on ? PROT_NONE : PROT_READ | PROT_WRITE);
+    }
+}
+
+static struct region * region_of(uintptr_t address) {
+    for (unsigned i = 0; i < REGIONS; i++) {
+        if (address >= regions[i].base && address < regions[i].base + regions[i].size) return &regions[i];
+    }
+    return NULL;
+}
+
+/*
+ * GPIO
+ */
+#define GPIOS 5
+
+static GPIO_TypeDef * const gpios[GPIOS] = { GPIOA, GPIOB, GPIOC, GPIOD, GPIOE };
+static uint16_t gpio_driven[GPIOS];
+static uint16_t gpio_levels[GPIOS];
+
+static uint32_t gpio_input(unsigned port) {
+    GPIO_TypeDef * gpio = gpios[port];
+    uint32_t idr = 0;
+    for (unsigned pin = 0; pin < 16; pin++) {
+        uint32_t config = ((pin < 8 ? gpio->CRL : gpio->CRH) >> ((pin & 7) * 4)) & 0xF;
+        uint32_t bit = 1 << pin;
+        uint32_t level;
+        if (config & 0x3) {
+            level = gpio->ODR & bit;                /* output */
+        } else if (gpio_driven[port] & bit) {
+            level = gpio_levels[port] & bit;        /* driven from outside */
+        } else if ((config >> 2) == 2) {
+            level = gpio->ODR & bit;                /* pull-up/pull-down */
+        } else {
+            level = 0;                              /* analog or floating */
+        }
+        idr |= level;
+    }
+    return idr;
+}
+
+/*
+ * Timers
+ */
+struct timer {
+    TIM_TypeDef * tim;
+    IRQn_Type update_irq;
+    IRQn_Type compare_irq;
+    uint32_t prescaler_cycles;
+};
+
+static struct timer timers[] = {
+    { TIM1, TIM1_UP_IRQn, TIM1_CC_IRQn },
+    { TIM2, TIM2_IRQn, TIM2_IRQn },
+    { TIM3, TIM3_IRQn, TIM3_IRQn },
+    { TIM4, TIM4_IRQn, TIM4_IRQn }
+};
+
+#define TIMERS (sizeof(timers) / sizeof(timers[0]))
+
+static void timer_tick(struct timer * timer) {
+    TIM_TypeDef * tim = timer->tim;
+    if (tim->CNT >= tim->ARR) {
+        tim->CNT = 0;
+        tim->SR |= TIM_SR_UIF;
+    } else {
+        tim->CNT++;
+    }
+    volatile uint32_t * ccr = &tim->CCR1;
+    for (unsigned channel = 0; channel < 4; channel++) {
+        if (tim->CNT == ccr[channel]) tim->SR |= TIM_SR_CC1IF << channel;
+    }
+}
+
+/*
+ * Hooks of the register accesses, they run with unprotected registers
+ */
+static void read_hook(uintptr_t address) {
+    for (unsigned port = 0; port < GPIOS; port++) {
+        if (address == REG(gpios[port]->IDR)) gpios[port]->IDR = gpio_input(port);
+    }
+    if (address == REG(DWT->CYCCNT)) DWT->CYCCNT = (uint32_t) mock_cycles;
+    for (unsigned i = 0; i < 8; i++) {
+        if (address == REG(NVIC->ICER[i])) NVIC->ICER[i] = NVIC->ISER[i];
+    }
+}
+
+static void write_hook(uintptr_t address, uint32_t old, uint32_t value) {
+    volatile uint32_t * reg = (volatile uint32_t *) address;
+
+    for (unsigned port = 0; port < GPIOS; port++) {
+        GPIO_TypeDef * gpio = gpios[port];
+        if (address == REG(gpio->BSRR)) {
+            gpio->ODR = (gpio->ODR & ~(value >> 16)) | (value & 0xFFFF);
+            *reg = 0;
+        } else if (address == REG(gpio->BRR)) {
+            gpio->ODR &= ~(value & 0xFFFF);
+            *reg = 0;
+        } else if (address == REG(gpio->IDR)) {
+            *reg = old;
+        }
+    }
+
+    for (unsigned i = 0; i < TIMERS; i++) {
+        TIM_TypeDef * tim = timers[i].tim;
+        if (address == REG(tim->SR)) {
+            *reg = old & value;                     /* rc_w0 */
+        } else if (address == REG(tim->EGR)) {
+            if (value & TIM_EGR_UG) {
+                tim->CNT = 0;
+                timers[i].prescaler_cycles = 0;
+                tim->SR |= TIM_SR_UIF;
+            }
+            *reg = 0;
+        }
+    }
+
+    if (address == REG(RCC->CR)) {
+        value &= ~(RCC_CR_HSIRDY | RCC_CR_HSERDY | RCC_CR_PLLRDY);
+        if (value & RCC_CR_HSION) value |= RCC_CR_HSIRDY;
+        if (value & RCC_CR_HSEON) value |= RCC_CR_HSERDY;
+        if (value & RCC_CR_PLLON) value |= RCC_CR_PLLRDY;
+        *reg = value;
+    } else if (address == REG(RCC->CFGR)) {
+        *reg = (value & ~RCC_CFGR_SWS) | ((value & RCC_CFGR_SW) << 2);
+    } else if (address == REG(SysTick->VAL)) {
+        *reg = 0;
+        SysTick->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+    }
+
+    for (unsigned i = 0; i < 8; i++) {
+        if (address == REG(NVIC->ISER[i])) {
+            *reg = old | value;
+        } else if (address == REG(NVIC->ICER[i])) {
+            NVIC->ISER[i] &= ~value;
+            *reg = NVIC->ISER[i];
+        }
+    }
+}
+
+static void record(uintptr_t address, uint32_t value, int write) {
+    struct region * region = region_of(address);
+    unsigned index = (address - region->base) / 4;
+    if (write) region->writes[index]++; else region->reads[index]++;
+
+    if (mock_accesses < MOCK_TRACE_SIZE) {
+        mock_trace[mock_accesses] = (struct mock_access) { mock_cycles, address, value, write };
+    }
+    mock_accesses++;
+}
+
+/*
+ * An access to the registers traps: The read hook is called, the registers are
+ * unprotected and the instruction is executed in single step mode.
+ */
+static uintptr_t pending_address;
+static uint32_t pending_old;
+static int pending_write;
+
+static void on_segmentation_fault(int signal, siginfo_t * info, void * context) {
+    ucontext_t * ucontext = context;
+    uintptr_t address = (uintptr_t) info->si_addr & ~(uintptr_t) 3;
+    if (region_of(address) == NULL) {
+        /* a real segmentation fault: crash when the instruction is executed again */
+        struct sigaction action = { .sa_handler = SIG_DFL };
+        sigaction(SIGSEGV, &action, NULL);
+        return;
+    }
+    lock(0);
+    read_hook(address);
+    pending_address = address;
+    pending_old = *(volatile uint32_t *) address;
+    pending_write = (ucontext->uc_mcontext.gregs[REG_ERR] & PAGE_FAULT_WRITE) != 0;
+    ucontext->uc_mcontext.gregs[REG_EFL] |= TRAP_FLAG;
+}
+
+static void on_trap(int signal, siginfo_t * info, void * context) {
+    ucontext_t * ucontext = context;
+    ucontext->uc_mcontext.gregs[REG_EFL] &= ~TRAP_FLAG;
+    uint32_t value = *(volatile uint32_t *) pending_address;
+    if (pending_write) write_hook(pending_address, pending_old, value);
+    record(pending_address, value, pending_write);
+    lock(1);
+}
+
+static void map() {
+    for (unsigned i = 0; i < REGIONS; i++) {
+        void * memory = mmap((void *) regions[i].base, regions[i].size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (memory != (void *) regions[i].base) {
+            fprintf(stderr, "mock: can not map the registers at 0x%08lx\n", (unsigned long) regions[i].base);
+            exit(EXIT_FAILURE);
+        }
+        regions[i].reads = calloc(regions[i].size / 4, sizeof(uint32_t));
+        regions[i].writes = calloc(regions[i].size / 4, sizeof(uint32_t));
+    }
+
+    struct sigaction action = { .sa_flags = SA_SIGINFO };
+    sigemptyset(&action.sa_mask);
+    action.sa_sigaction = on_segmentation_fault;
+    sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = on_trap;
+    sigaction(SIGTRAP, &action, NULL);
+}
+
+void mock_trace_clear() {
+    for (unsigned i = 0; i < REGIONS; i++) {
+        memset(regions[i].reads, 0, regions[i].size / 4 * sizeof(uint32_t));
+        memset(regions[i].writes, 0, regions[i].size / 4 * sizeof(uint32_t));
+    }
+    mock_accesses = 0;
+}
+
+void mock_init() {
+    static int mapped = 0;
+    if (!mapped) {
+        map();
+        mapped = 1;
+    } else {
+        lock(0);
+    }
+
+    for (unsigned i = 0; i < REGIONS; i++) memset((void *) regions[i].base, 0, regions[i].size);
+
+    /* reset values */
+    RCC->CR = 0x83;
+    for (unsigned port = 0; port < GPIOS; port++) {
+        gpios[port]->CRL = 0x44444444;
+        gpios[port]->CRH = 0x44444444;
+        gpio_driven[port] = 0;
+        gpio_levels[port] = 0;
+    }
+    for (unsigned i = 0; i < TIMERS; i++) {
+        timers[i].tim->ARR = 0xFFFF;
+        timers[i].prescaler_cycles = 0;
+    }
+
+    mock_cycles = 0;
+    interrupts = 0;
+    mock_trace_clear();
+    lock(1);
+}
+
+unsigned mock_reads(const volatile void * reg) {
+    struct region * region = region_of((uintptr_t) reg);
+    return region->reads[((uintptr_t) reg - region->base) / 4];
+}
+
+unsigned mock_writes(const volatile void * reg) {
+    struct region * region = region_of((uintptr_t) reg);
+    return region->writes[((uintptr_t) reg - region->base) / 4];
+}
+
+uint32_t mock_peek(const volatile void * reg) {
+    lock(0);
+    uint32_t value = *(const volatile uint32_t *) reg;
+    lock(1);
+    return value;
+}
+
+void mock_gpio_drive(GPIO_TypeDef * gpio, uint16_t pins, uint16_t levels) {
+    for (unsigned port = 0; port < GPIOS; port++) {
+        if (gpios[port] == gpio) {
+            gpio_driven[port] |= pins;
+            gpio_levels[port] = (gpio_levels[port] & ~pins) | (levels & pins);
+        }
+    }
+}
+
+/*
+ * Calls a handler of the vector table with protected registers.
+ */
+static void call_handler(int irq) {
+    lock(1);
+    ((void (*)()) vector_table[16 + irq])();
+    lock(0);
+    interrupts++;
+}
+
+static int irq_enabled(IRQn_Type irq) {
+    return (NVIC->ISER[irq >> 5] >> (irq & 0x1F)) & 1;
+}
+
+static void dispatch(int sys_tick) {
+    if (sys_tick) call_handler(SysTick_IRQn);
+    for (unsigned i = 0; i < TIMERS; i++) {
+        TIM_TypeDef * tim = timers[i].tim;
+        uint32_t flags = tim->SR & tim->DIER;
+        if ((flags & TIM_SR_UIF) && irq_enabled(timers[i].update_irq)) {
+            call_handler(timers[i].update_irq);
+            flags = tim->SR & tim->DIER;
+        }
+        if ((flags & (TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF))
+                && irq_enabled(timers[i].compare_irq)) {
+            call_handler(timers[i].compare_irq);
+        }
+    }
+}
+
+/*
+ * Advances the time by cycles, or until an interrupt has been handled.
+ */
+static void run(uint64_t cycles, int until_interrupt) {
+    unsigned handled = interrupts;
+    lock(0);
+    while (cycles > 0 && !(until_interrupt && interrupts != handled)) {
+        /* advance to the next event */
+        uint64_t step = cycles;
+        for (unsigned i = 0; i < TIMERS; i++) {
+            TIM_TypeDef * tim = timers[i].tim;
+            if (tim->CR1 & TIM_CR1_CEN) {
+                uint64_t next_tick = tim->PSC + 1 - timers[i].prescaler_cycles;
+                if (next_tick < step) step = next_tick;
+            }
+        }
+        int sys_tick_enabled = SysTick->CTRL & SysTick_CTRL_ENABLE_Msk;
+        if (sys_tick_enabled) {
+            if (SysTick->VAL == 0) SysTick->VAL = SysTick->LOAD;
+            if (SysTick->VAL < step) step = SysTick->VAL;
+        }
+        if (step == 0) step = 1;
+
+        mock_cycles += step;
+        cycles -= step;
+
+        for (unsigned i = 0; i < TIMERS; i++) {
+            if (timers[i].tim->CR1 & TIM_CR1_CEN) {
+                timers[i].prescaler_cycles += step;
+                if (timers[i].prescaler_cycles > timers[i].tim->PSC) {
+                    timers[i].prescaler_cycles = 0;
+                    timer_tick(&timers[i]);
+                }
+            }
+        }
+
+        int sys_tick = 0;
+        if (sys_tick_enabled) {
+            SysTick->VAL -= step;
+            if (SysTick->VAL == 0) {
+                SysTick->VAL = SysTick->LOAD;
+                SysTick->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+                sys_tick = (SysTick->CTRL & SysTick_CTRL_TICKINT_Msk) != 0;
+            }
+        }
+
+        dispatch(sys_tick);
+    }
+    lock(1);
+}
+
+void mock_advance(uint64_t cycles) {
+    run(cycles, 0);
+}
+
+void mock_wait_for_interrupt(uint64_t max_cycles) {
+    run(max_cycles, 1);
+}
@@ -0,0 +1,94 @@
+/*
+ * peripherals simulates the peripheral registers of the STM32F103 on the host (Linux x86-64).
+ *
+ * The board code is compiled unchanged against the CMSIS headers:
+ * Memory is mapped at the addresses of the peripherals (0x40000000) and
+ * of the system control space (0xE0000000), so `GPIOA`, `TIM4` or `NVIC` point to it.
+ * The memory is protected, so every access traps:
+ * A read hook updates the register before the instruction reads it,
+ * then the instruction is executed in single step mode
+ * and a write hook applies the effect of the written value.
+ * Every access costs two signals, about 5 µs.
+ *
+ * Modelled behaviour:
+ *
+ *  - RCC:     ready flags follow HSEON, HSION and PLLON, SWS follows SW
+ *  - GPIO:    BSRR and BRR change ODR, IDR reads outputs, pull-ups/downs and driven input pins
+ *  - TIM1-4:  up counting with prescaler and auto reload, update and compare flags,
+ *             SR is rc_w0, EGR.UG, interrupts to the handlers of the vector table
+ *  - SysTick: down counting and its interrupt
+ *  - NVIC:    ISER/ICER
+ *  - DWT:     CYCCNT is the simulated cycle counter
+ *
+ * Everything else is plain memory. Read-modify-write instructions are recorded as writes.
+ * Time only passes in `mock_advance`, which also calls the interrupt handlers.
+ * Interrupts do not preempt each other.
+ *
+ * The mock works only on Linux x86-64: It needs mmap at fixed low addresses,
+ * SIGSEGV with the faulting address and the trap flag in the saved EFLAGS (REG_EFL).
+ * test/CMakeLists.txt builds the tests using it only on this platform.
+ */
+
+#ifndef TEST_MOCK_PERIPHERALS_H
+#define TEST_MOCK_PERIPHERALS_H
+
+#include <stdint.h>
+#include <stm32f1xx.h>
+
+struct mock_access {
+    uint64_t cycles;
+    uint32_t address;
+    uint32_t value;
+    int write;
+};
+
+#define MOCK_TRACE_SIZE 4096
+
+/*
+ * Recorded accesses (the first MOCK_TRACE_SIZE) and their number
+ */
+extern struct mock_access mock_trace[MOCK_TRACE_SIZE];
+extern unsigned mock_accesses;
+
+/*
+ * Simulated processor cycles
+ */
+extern uint64_t mock_cycles;
+
+/*
+ * Maps the registers and resets them to their reset values. It clears the trace.
+ */
+void mock_init();
+
+/*
+ * Clears the trace and the access counters.
+ */
+void mock_trace_clear();
+
+/*
+ * Number of reads and writes of a register since the last clear
+ */
+unsigned mock_reads(const volatile void * reg);
+unsigned mock_writes(const volatile void * reg);
+
+/*
+ * Advances the time by cycles and calls the handlers of the interrupts that occur.
+ */
+void mock_advance(uint64_t cycles);
+
+/*
+ * Advances the time until an interrupt has been handled or max_cycles have passed.
+ */
+void mock_wait_for_interrupt(uint64_t max_cycles);
+
+/*
+ * Drives input pins of a port from outside.
+ */
+void mock_gpio_drive(GPIO_TypeDef * gpio, uint16_t pins, uint16_t levels);
+
+/*
+ * Reads a register without recording the access.
+ */
+uint32_t mock_peek(const volatile void * reg);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Implementation of the runtime system functions on the simulated registers
+ */
+
+#include "runtime/system.h"
+#include "system.h"
+#include "peripherals.h"
+
+#include <stdlib.h>
+
+uint32_t system_core_clock = 8000000;
+uint32_t system_apb1_clock = 8000000;
+
+void (* mock_system_wait_hook)();
+
+void system_init() {
+}
+
+void system_reset() {
+    abort();
+}
+
+void system_core_clock_update() {
+}
+
+void system_tick_config(uint32_t ticks) {
+    SysTick_Config(ticks);
+}
+
+void system_wait_for_event() {
+    if (mock_system_wait_hook) mock_system_wait_hook();
+    mock_wait_for_interrupt(system_core_clock);
+}
+
+void system_cycle_counter_enable() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
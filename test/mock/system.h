@@ -0,0 +1,14 @@
+/*
+ * Mock of the runtime system functions: The registers are simulated (see peripherals.h)
+ * and waiting for an event advances the simulated time to the next interrupt (at most 1 s).
+ */
+
+#ifndef TEST_MOCK_SYSTEM_H
+#define TEST_MOCK_SYSTEM_H
+
+/*
+ * Called by `system_wait_for_event` before waiting, e.g. to change the inputs or to end a test
+ */
+extern void (* mock_system_wait_hook)();
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Microbenchmarks of the runtime on the target and on the host.
+ *
+ * A statement is executed BENCH_RUNS times and every run is timed on its own,
+ * with the DWT cycle counter on the target and in nanoseconds on the host.
+ * Minimum, median and maximum of the runs are stored in `bench_results`,
+ * which can be inspected with the debugger, and printed by `bench_report`.
+ * The first result should be the empty statement: it is the overhead of the measurement.
+ * A compiler barrier after the statement keeps its stores to memory.
+ *
+ * On the target the report is written with semihosting if a debugger is attached.
+ */
+
+#ifndef TEST_RUNTIME_BENCH_H
+#define TEST_RUNTIME_BENCH_H
+
+#include <stdint.h>
+
+#define BENCH_RUNS 101
+#define BENCH_RESULTS 16
+
+struct bench_result {
+    const char * name;
+    uint32_t min;
+    uint32_t median;
+    uint32_t max;
+};
+
+static struct bench_result bench_results[BENCH_RESULTS];
+static unsigned bench_count;
+static uint32_t bench_samples[BENCH_RUNS];
+
+#if defined(__arm__)
+
+#include <stm32f1xx.h>
+#include "runtime/semihosting.h"
+
+#define BENCH_UNIT "cycles"
+
+static inline uint32_t bench_clock() {
+    return DWT->CYCCNT;
+}
+
+static inline void bench_write(const char * text) {
+    if (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) semihosting_write(text);
+}
+
+#else
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_UNIT "ns"
+
+static inline uint32_t bench_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+static inline void bench_write(const char * text) {
+    fputs(text, stdout);
+}
+
+#endif
+
+/*
+ * Stores minimum, median and maximum of the samples as the next result.
+ */
+static inline void bench_result(const char * name) {
+    for (unsigned i = 1; i < BENCH_RUNS; i++) {
+        uint32_t sample = bench_samples[i];
+        unsigned j = i;
+        for (; j > 0 && bench_samples[j - 1] > sample; j--) bench_samples[j] = bench_samples[j - 1];
+        bench_samples[j] = sample;
+    }
+    if (bench_count == BENCH_RESULTS) return;
+    struct bench_result * result = &bench_results[bench_count++];
+    result->name = name;
+    result->min = bench_samples[0];
+    result->median = bench_samples[BENCH_RUNS / 2];
+    result->max = bench_samples[BENCH_RUNS - 1];
+}
+
+#define BENCH(statement) do {                                   \
+        for (unsigned run = 0; run < BENCH_RUNS; run++) {       \
+            uint32_t start = bench_clock();                     \
+            statement;                                          \
+            __asm volatile ("" : : : "memory");                 \
+            bench_samples[run] = bench_clock() - start;         \
+        }                                                       \
+        bench_result(#statement);                               \
+    } while (0)
+
+/*
+ * Writes a number right aligned in a field of 10 characters.
+ */
+static inline void bench_write_number(uint32_t number) {
+    char text[12];
+    char * digit = &text[11];
+    *digit = 0;
+    do {
+        *--digit = '0' + number % 10;
+        number /= 10;
+    } while (number != 0);
+    while (digit > &text[1]) *--digit = ' ';
+    bench_write(&text[1]);
+}
+
+static inline void bench_report() {
+    bench_write("       min     median        max  " BENCH_UNIT "\n");
+    for (unsigned i = 0; i < bench_count; i++) {
+        bench_write_number(bench_results[i].min);
+        bench_write_number(bench_results[i].median);
+        bench_write_number(bench_results[i].max);
+        bench_write("  ");
+        bench_write(bench_results[i].name[0] ? bench_results[i].name : "(overhead)");
+        bench_write("\n");
+    }
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Host variant of the runtime benchmark (see bench.h and bench_runtime.c).
+ *
+ * It measures the hardware independent primitives in nanoseconds:
+ * the copies of `_start`, the copy functions of the runtime compared to the C library
+ * and the beat handler of the framework without input ports.
+ * The system functions are stubs, the primitives that access registers are only measured on the target.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "framework/hooks.h"
+#include "runtime/memory.h"
+#include "runtime/system.h"
+#include "bench.h"
+
+/* the framework handler of the beat */
+void on_sys_tick();
+
+uint32_t system_core_clock = 8000000;
+
+void system_core_clock_update() {
+}
+
+void system_tick_config(uint32_t ticks) {
+}
+
+void system_wait_for_event() {
+}
+
+void setup() {
+}
+
+unsigned init() {
+    return 1000;
+}
+
+void step(unsigned beat) {
+}
+
+static char source[1024];
+static char scratch[1024];
+
+int main(int argc, char ** argv) {
+    BENCH();
+    BENCH(memset(scratch, 0, 64));
+    BENCH(memcpy(scratch, source, 64));
+    BENCH(memset(scratch, 0, sizeof(scratch)));
+    BENCH(memcpy(scratch, source, sizeof(scratch)));
+    BENCH(memcpy(scratch + 1, source, sizeof(scratch) - 1));
+    BENCH(memmove(scratch + 4, scratch, sizeof(scratch) - 4));
+    BENCH(runtime_memset(scratch, 0, sizeof(scratch)));
+    BENCH(runtime_memcpy(scratch, source, sizeof(scratch)));
+    BENCH(runtime_memcpy(scratch + 1, source, sizeof(scratch) - 1));
+    BENCH(runtime_memmove(scratch + 4, scratch, sizeof(scratch) - 4));
+    BENCH(on_sys_tick());
+    bench_report();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+/*
+ * Cycle benchmark of the runtime and the framework on the target (see bench.h).
+ *
+ * The application runs in the framework:
+ * `setup` measures the primitives directly at 72 MHz,
+ * `step` measures the wake path from the beat edge (SysTick reload)
+ * through `on_sys_tick` and `next_beat` to the start of the step.
+ * memcpy, memset and memmove are the ones of newlib-nano or with RUNTIME_STRING of the runtime,
+ * the functions of the runtime are measured as well to compare both.
+ * The green LED is switched on when the benchmark has finished.
+ */
+
+#include <stm32f1xx.h>
+#include <string.h>
+#include "framework/hooks.h"
+#include "framework/inputs.h"
+#include "runtime/memory.h"
+#include "runtime/system.h"
+#include "bench.h"
+
+#define PIN13 (1 << 13)
+
+#define BEATS_PER_SECOND 1000
+
+/* the framework handler of the beat */
+void on_sys_tick();
+
+/* provided by the linker */
+extern char __data_load;
+extern char __data_start;
+extern char __data_end;
+extern char __bss_start__;
+extern char __bss_end__;
+
+static char scratch[1024] __attribute__ ((aligned (4)));
+
+void setup() {
+    RCC->APB2ENR |= RCC_APB2ENR_IOPCEN;
+    GPIOC->BSRR = PIN13;
+    GPIOC->CRH = 0x44644444;
+
+    system_clock_frequency(CLOCK_FRQ_72_MHZ);
+    system_cycle_counter_enable();
+    input_config(1 << INPUT_PORT_A, 0);
+
+    size_t data_size = &__data_end - &__data_start;
+    size_t bss_size = &__bss_end__ - &__bss_start__;
+    if (data_size > sizeof(scratch)) data_size = sizeof(scratch);
+    if (bss_size > sizeof(scratch)) bss_size = sizeof(scratch);
+
+    BENCH();
+    BENCH(memset(scratch, 0, bss_size));
+    BENCH(memcpy(scratch, &__data_load, data_size));
+    BENCH(memset(scratch, 0, sizeof(scratch)));
+    BENCH(memcpy(scratch, &__data_load, sizeof(scratch)));
+    BENCH(memcpy(scratch + 1, &__data_load, sizeof(scratch) - 1));
+    BENCH(memmove(scratch + 4, scratch, sizeof(scratch) - 4));
+    BENCH(runtime_memset(scratch, 0, sizeof(scratch)));
+    BENCH(runtime_memcpy(scratch, &__data_load, sizeof(scratch)));
+    BENCH(runtime_memcpy(scratch + 1, &__data_load, sizeof(scratch) - 1));
+    BENCH(runtime_memmove(scratch + 4, scratch, sizeof(scratch) - 4));
+    BENCH(system_core_clock_update());
+    BENCH(system_clock_frequency(CLOCK_FRQ_72_MHZ));
+    BENCH(on_sys_tick());
+}
+
+unsigned init() {
+    return BEATS_PER_SECOND;
+}
+
+/*
+ * SysTick counts down from LOAD, so LOAD - VAL are the cycles since the beat edge.
+ * A sample is only taken if the step follows the previous one by one beat,
+ * i.e. the main loop has waited for the beat edge:
+ * The main loop calls step(0) without waiting, and `setup` has advanced the beat
+ * by calling `on_sys_tick` BENCH_RUNS times, so the next step (beat BENCH_RUNS) starts at once as well.
+ */
+void step(unsigned beat) {
+    static unsigned previous = 0;
+    static unsigned run = 0;
+    uint32_t cycles = SysTick->LOAD - SysTick->VAL;
+
+    int waited = beat == previous + 1;
+    previous = beat;
+    if (!waited) return;
+    if (run < BENCH_RUNS) {
+        bench_samples[run++] = cycles;
+        if (run == BENCH_RUNS) {
+            bench_result("beat edge to step");
+            bench_report();
+            GPIOC->BRR = PIN13;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+/*
+ * Reporting of the tests that run on the target or in QEMU.
+ *
+ * The results are written to the console with semihosting
+ * and the test ends with the exit status of the host.
+ */
+
+#ifndef TEST_RUNTIME_TARGET_TEST_H
+#define TEST_RUNTIME_TARGET_TEST_H
+
+#include "runtime/semihosting.h"
+
+static int failures = 0;
+
+static inline void check(const char * name, int ok) {
+    semihosting_write(name);
+    semihosting_write(ok ? " ok\n" : " FAILED\n");
+    if (!ok) failures++;
+}
+
+static inline void test_exit() {
+    semihosting_exit(failures);
+}
+
+#endif
@@ -1,7 +1,10 @@
 /*
- * Test of crt.c
+ * Test of cstart.c: The BSS segment is cleared and the data segment is initialized
  */
 
+#include <string.h>
+#include "target_test.h"
+
 int a;
 int b = 15;
 int c;
@@ -16,19 +19,15 @@ char buffer[128] = {
 const char * str = "This is data";
 
 int main(int argc, char **argv) {
-    int tmp = a;
-    tmp = b;
-    tmp = c;
-    tmp = d;
-    tmp = e;
-    tmp = f;
-    a = tmp;
-    char l = buffer[2];
-    char o = buffer[4];
-    buffer[6] = o;
-    const char * a = str;
-    buffer[8] = l;
-    buffer[9] = 0;
-    buffer[7] = a[5];
+    check("bss cleared", a == 0 && c == 0 && d == 0);
+    check("data initialized", b == 15 && f == 42 && strcmp(buffer, "hallo!") == 0);
+    check("rodata", e == 34 && strcmp(str, "This is data") == 0);
+
+    a = f;
+    buffer[6] = buffer[4];
+    buffer[7] = str[5];
+    check("data writable", a == 42 && strcmp(buffer, "hallo!oi") == 0);
+
+    test_exit();
     return 0;
 }
@@ -0,0 +1,70 @@
+/*
+ * Test of the critical sections: nesting, masking with BASEPRI and the measured duration.
+ *
+ * The SysTick interrupt is pended by software, so it runs as soon as its priority is not masked.
+ */
+
+#include <stm32f1xx.h>
+#include "runtime/irq.h"
+#include "target_test.h"
+
+#define BASEPRI(level) ((level) << IRQ_PRIORITY_SHIFT)
+
+static const struct irq_priority irq_priority_table[] = {
+    { SysTick_IRQn, 6 },
+};
+
+static volatile unsigned ticks;
+
+void on_sys_tick() {
+    ticks++;
+}
+
+static void pend_sys_tick() {
+    SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+    __DSB();
+    __ISB();
+}
+
+int main(int argc, char **argv) {
+    irq_priorities(irq_priority_table, sizeof(irq_priority_table) / sizeof(irq_priority_table[0]));
+    check("priority table", NVIC_GetPriority(SysTick_IRQn) == 6);
+
+    uint32_t start = DWT->CYCCNT;
+    uint32_t outer = critical_enter(8);
+    int ok = outer == 0 && __get_BASEPRI() == BASEPRI(8);
+    pend_sys_tick();
+    ok = ok && ticks == 1;              /* priority 6 is not masked by level 8 */
+
+    uint32_t inner = critical_enter(4);
+    ok = ok && inner == BASEPRI(8) && __get_BASEPRI() == BASEPRI(4);
+    pend_sys_tick();
+    ok = ok && ticks == 1;              /* masked by level 4 */
+
+    uint32_t innermost = critical_enter(10);
+    ok = ok && __get_BASEPRI() == BASEPRI(4);   /* an inner section does not lower the level */
+    critical_exit(innermost);
+    ok = ok && __get_BASEPRI() == BASEPRI(4) && ticks == 1;
+
+    critical_exit(inner);
+    __ISB();
+    ok = ok && __get_BASEPRI() == BASEPRI(8) && ticks == 2;
+    check("nested levels", ok);
+
+    critical_exit(outer);
+    uint32_t cycles = DWT->CYCCNT - start;
+    check("level restored", __get_BASEPRI() == 0);
+
+    /*
+     * Only the outermost section is measured.
+     * QEMU does not model the cycle counter.
+     */
+    if (cycles != 0) {
+        check("longest section", critical_max_cycles > 0 && critical_max_cycles <= cycles);
+    } else {
+        semihosting_write("longest section skipped: the cycle counter does not count\n");
+    }
+
+    test_exit();
+    return 0;
+}
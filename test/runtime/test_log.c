@@ -0,0 +1,100 @@
+/*
+ * Host test of the binary log ring buffer.
+ */
+
+#include "runtime/log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__x86_64__)
+#include <signal.h>
+#endif
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+static const char * format(const struct log_entry * entry) {
+    return (const char *) (uintptr_t) entry->format;
+}
+
+static void test_arguments() {
+    memset(&log_buffer, 0, sizeof(log_buffer));
+    LOG("none");
+    LOG("one %d", -1);
+    LOG("three %d %u %x", 1, 2, 3);
+    const struct log_entry * e = log_buffer.entries;
+    int ok = log_buffer.head == 3;
+    ok = ok && strcmp(format(&e[0]), "none") == 0 && e[0].args[0] == 0;
+    ok = ok && strcmp(format(&e[1]), "one %d") == 0 && e[1].args[0] == 0xFFFFFFFF && e[1].args[1] == 0;
+    ok = ok && strcmp(format(&e[2]), "three %d %u %x") == 0;
+    ok = ok && e[2].args[0] == 1 && e[2].args[1] == 2 && e[2].args[2] == 3;
+    check("arguments", ok);
+}
+
+static void test_wrap() {
+    memset(&log_buffer, 0, sizeof(log_buffer));
+    for (int i = 0; i < LOG_SIZE + 5; i++) LOG("entry %d", i);
+    int ok = log_buffer.head == LOG_SIZE + 5;
+    for (int i = 0; i < LOG_SIZE; i++) {
+        uint32_t expected = i < 5 ? LOG_SIZE + i : i;
+        ok = ok && log_buffer.entries[i].args[0] == expected;
+    }
+    check("wrap", ok);
+}
+
+#if defined(__linux__) && defined(__x86_64__)
+/*
+ * log_write is executed in single step mode (trap flag of x86-64).
+ * After every instruction the slot must be marked as invalid
+ * or hold a complete entry, either the old or the new one.
+ */
+#define TRAP_FLAG 0x100
+
+static const char old_format[] = "old";
+static const char new_format[] = "new";
+static int torn;
+static int marked;
+
+static int complete(const struct log_entry * entry, const char * format, uint32_t arg) {
+    return entry->format == (uint32_t) (uintptr_t) format
+        && entry->args[0] == arg && entry->args[1] == arg && entry->args[2] == arg;
+}
+
+static void on_trap(int signal) {
+    const struct log_entry * entry = &log_buffer.entries[0];
+    if (entry->format == LOG_INVALID) {
+        marked = 1;
+    } else if (!complete(entry, old_format, 1) && !complete(entry, new_format, 2)) {
+        torn = 1;
+    }
+}
+
+static void test_half_written() {
+    signal(SIGTRAP, on_trap);
+    memset(&log_buffer, 0, sizeof(log_buffer));
+    log_write((uint32_t) (uintptr_t) old_format, 1, 1, 1);
+    log_buffer.head = 0;
+    torn = 0;
+    marked = 0;
+    __asm__ volatile ("pushf; orq %0, (%%rsp); popf" : : "i" (TRAP_FLAG) : "memory", "cc");
+    log_write((uint32_t) (uintptr_t) new_format, 2, 2, 2);
+    __asm__ volatile ("pushf; andq %0, (%%rsp); popf" : : "i" (~TRAP_FLAG) : "memory", "cc");
+    signal(SIGTRAP, SIG_DFL);
+    check("half written", marked && !torn && complete(&log_buffer.entries[0], new_format, 2));
+}
+#endif
+
+int main(int argc, char ** argv) {
+    test_arguments();
+    test_wrap();
+#if defined(__linux__) && defined(__x86_64__)
+    test_half_written();
+#endif
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*
+ * Host test of the copy and fill functions against the C library
+ * with random sizes and alignments.
+ */
+
+#include "runtime/memory.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+#define BUFFER 512
+#define MAX_SIZE 300
+#define RUNS 20000
+
+static uint8_t actual[BUFFER] __attribute__ ((aligned (8)));
+static uint8_t expected[BUFFER] __attribute__ ((aligned (8)));
+static uint8_t source[BUFFER] __attribute__ ((aligned (8)));
+
+static void randomize(uint8_t * buffer) {
+    for (int i = 0; i < BUFFER; i++) buffer[i] = rand();
+}
+
+static void test_memcpy() {
+    int ok = 1;
+    for (int run = 0; run < RUNS && ok; run++) {
+        size_t size = rand() % MAX_SIZE;
+        size_t to = rand() % 8, from = rand() % 8;
+        randomize(actual);
+        memcpy(expected, actual, BUFFER);
+        randomize(source);
+        void * result = runtime_memcpy(actual + to, source + from, size);
+        memcpy(expected + to, source + from, size);
+        ok = result == actual + to && memcmp(actual, expected, BUFFER) == 0;
+    }
+    check("memcpy", ok);
+}
+
+static void test_memset() {
+    int ok = 1;
+    for (int run = 0; run < RUNS && ok; run++) {
+        size_t size = rand() % MAX_SIZE;
+        size_t to = rand() % 8;
+        int value = rand() % 512 - 256;
+        randomize(actual);
+        memcpy(expected, actual, BUFFER);
+        void * result = runtime_memset(actual + to, value, size);
+        memset(expected + to, value, size);
+        ok = result == actual + to && memcmp(actual, expected, BUFFER) == 0;
+    }
+    check("memset", ok);
+}
+
+/*
+ * Source and destination in the same buffer, overlapping in both directions
+ */
+static void test_memmove() {
+    int ok = 1;
+    for (int run = 0; run < RUNS && ok; run++) {
+        size_t size = rand() % MAX_SIZE;
+        size_t to = rand() % (BUFFER - MAX_SIZE), from = rand() % (BUFFER - MAX_SIZE);
+        randomize(actual);
+        memcpy(expected, actual, BUFFER);
+        void * result = runtime_memmove(actual + to, actual + from, size);
+        memmove(expected + to, expected + from, size);
+        ok = result == actual + to && memcmp(actual, expected, BUFFER) == 0;
+    }
+    check("memmove", ok);
+}
+
+static void test_memmove_near() {
+    int ok = 1;
+    for (int distance = -20; distance <= 20 && ok; distance++) {
+        for (size_t size = 0; size < 64 && ok; size++) {
+            randomize(actual);
+            memcpy(expected, actual, BUFFER);
+            runtime_memmove(actual + 100 + distance, actual + 100, size);
+            memmove(expected + 100 + distance, expected + 100, size);
+            ok = memcmp(actual, expected, BUFFER) == 0;
+        }
+    }
+    check("memmove overlapping", ok);
+}
+
+int main(int argc, char ** argv) {
+    srand(47);
+    test_memcpy();
+    test_memset();
+    test_memmove();
+    test_memmove_near();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+/*
+ * Test of the vector table: The SysTick interrupt reaches its handler.
+ */
+
+#include <stm32f1xx.h>
+#include "runtime/system.h"
+#include "target_test.h"
+
+#define TICKS 10
+
+static volatile unsigned ticks;
+
+void on_sys_tick() {
+    ticks++;
+}
+
+int main(int argc, char **argv) {
+    check("vector table in flash", SCB->VTOR == FLASH_BASE);
+
+    system_tick_config(system_core_clock / 1000);
+    while (ticks < TICKS) {
+        system_wait_for_event();
+    }
+    check("sys tick handler", ticks >= TICKS);
+
+    test_exit();
+    return 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * Mock implementation of the servo board interface
+ */
+
+#include "board.h"
+#include "board_mock.h"
+
+struct board_mock board_mock = { .switch_position = -1 };
+
+void moving_led_on() {
+    board_mock.moving_led = 1;
+}
+
+void moving_led_off() {
+    board_mock.moving_led = 0;
+}
+
+void position_0_led_on() {
+    board_mock.position_led[0] = 1;
+}
+
+void position_0_led_off() {
+    board_mock.position_led[0] = 0;
+}
+
+void position_1_led_on() {
+    board_mock.position_led[1] = 1;
+}
+
+void position_1_led_off() {
+    board_mock.position_led[1] = 0;
+}
+
+int switch_position() {
+    return board_mock.switch_position;
+}
+
+void servo_position(int position) {
+    board_mock.servo_position = position;
+    board_mock.servo_updates++;
+}
@@ -0,0 +1,19 @@
+/*
+ * Mock of the servo board for host tests: It records the outputs and
+ * lets the test set the switch.
+ */
+
+#ifndef TEST_SERVO_BOARD_MOCK_H
+#define TEST_SERVO_BOARD_MOCK_H
+
+struct board_mock {
+    int moving_led;
+    int position_led[2];
+    int switch_position;
+    int servo_position;
+    unsigned servo_updates;
+};
+
+extern struct board_mock board_mock;
+
+#endif
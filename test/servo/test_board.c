@@ -0,0 +1,78 @@
+/*
+ * Host test of the servo board and the framework on simulated registers:
+ * The whole application runs with the beat of timer 4 (see test/mock/peripherals.h).
+ */
+
+#include "framework/hooks.h"
+#include "mock/peripherals.h"
+#include "mock/system.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int framework_main(int argc, char ** argv);
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+#define PIN0  (1 << 0)
+#define PIN3  (1 << 3)
+#define PIN5  (1 << 5)
+#define PIN7  (1 << 7)
+#define PIN13 (1 << 13)
+
+#define CYCLES_PER_BEAT 160000  /* 20 ms at 8 MHz */
+#define SWITCH_BEAT 10
+#define BEATS 100
+
+static jmp_buf end_of_test;
+static unsigned waits;
+static unsigned setup_accesses;
+
+/*
+ * Called before the main loop waits for the next beat
+ */
+static void on_wait() {
+    if (waits == 0) setup_accesses = mock_accesses;
+    waits++;
+    if (waits == SWITCH_BEAT) mock_gpio_drive(GPIOA, PIN3 | PIN5, PIN3);
+    if (waits == BEATS) longjmp(end_of_test, 1);
+}
+
+static void test_setup() {
+    mock_init();
+    setup();
+    check("clocks", (mock_peek(&RCC->APB2ENR) & (RCC_APB2ENR_IOPAEN | RCC_APB2ENR_IOPBEN | RCC_APB2ENR_IOPCEN))
+                    && (mock_peek(&RCC->APB1ENR) & RCC_APB1ENR_TIM4EN));
+    check("gpio config", mock_peek(&GPIOA->CRL) == 0x64848446 && mock_peek(&GPIOB->CRH) == 0x444444A4);
+    check("pwm period", mock_peek(&TIM4->PSC) == 7 && mock_peek(&TIM4->ARR) == 19999);
+    check("pwm middle", mock_peek(&TIM4->CCR4) == 1500 && (mock_peek(&TIM4->CR1) & TIM_CR1_CEN));
+    check("beat priority", mock_peek(&NVIC->IP[TIM4_IRQn]) == 2 << (8 - __NVIC_PRIO_BITS));
+    printf("setup: %u register accesses\n", mock_accesses);
+}
+
+static void test_run() {
+    mock_init();
+    mock_system_wait_hook = on_wait;
+    if (setjmp(end_of_test) == 0) framework_main(0, NULL);
+
+    unsigned beat_accesses = mock_accesses - setup_accesses;
+    check("beat period", mock_cycles / (BEATS - 1) == CYCLES_PER_BEAT);
+    check("position 1", mock_peek(&TIM4->CCR4) == 1500 - 900);
+    check("position 1 led on", !(mock_peek(&GPIOA->ODR) & PIN0) && (mock_peek(&GPIOA->ODR) & PIN7));
+    check("moving led off", mock_peek(&GPIOC->ODR) & PIN13);
+    check("beat flag cleared", !(mock_peek(&TIM4->SR) & TIM_SR_UIF));
+    check("one commit per port", mock_writes(&GPIOA->BSRR) <= BEATS && mock_writes(&GPIOB->BSRR) == 0);
+    printf("%u beats: %.1f register accesses per beat\n", BEATS - 1, (double) beat_accesses / (BEATS - 1));
+}
+
+int main(int argc, char ** argv) {
+    test_setup();
+    test_run();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
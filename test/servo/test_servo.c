@@ -0,0 +1,71 @@
+/*
+ * Host test of the servo application against the mock board.
+ */
+
+#include "framework/hooks.h"
+#include "board_mock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+
+static void check(const char * name, int ok) {
+    printf("%-22s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+/*
+ * Beats per second and velocity limit of servo.c
+ */
+#define BEATS_PER_SECOND 50
+#define MAX_STEP (3000 / BEATS_PER_SECOND)
+
+/*
+ * Steps until the servo has reached target or max_beats are done.
+ * It returns the number of beats and checks the velocity limit.
+ */
+static unsigned run(unsigned * beat, int target, unsigned max_beats, int * within_limits) {
+    unsigned beats = 0;
+    do {
+        int previous = board_mock.servo_position;
+        step((*beat)++);
+        beats++;
+        int delta = board_mock.servo_position - previous;
+        if (delta > MAX_STEP || delta < -MAX_STEP) *within_limits = 0;
+    } while (board_mock.servo_position != target && beats < max_beats);
+    return beats;
+}
+
+int main(int argc, char ** argv) {
+    unsigned beat = 0;
+    int within_limits = 1;
+
+    check("beats per second", init() == BEATS_PER_SECOND);
+
+    board_mock.switch_position = -1;
+    step(beat++);
+    check("rest in the middle", board_mock.servo_position == 0 && board_mock.servo_updates == 1);
+    /* the moving led is on between the end positions */
+    check("moving led on", board_mock.moving_led);
+
+    board_mock.switch_position = 0;
+    unsigned beats = run(&beat, 900, 1000, &within_limits);
+    check("reaches position 0", board_mock.servo_position == 900 && board_mock.position_led[0]);
+    check("position 1 led off", !board_mock.position_led[1] && !board_mock.moving_led);
+    check("move duration", beats > 900 / MAX_STEP && beats < 100);
+
+    board_mock.switch_position = 1;
+    run(&beat, -900, 1000, &within_limits);
+    check("reaches position 1", board_mock.servo_position == -900 && board_mock.position_led[1]);
+
+    /* the target is kept when the switch is between its positions */
+    board_mock.switch_position = 0;
+    step(beat++);
+    board_mock.switch_position = -1;
+    run(&beat, 900, 1000, &within_limits);
+    check("returns to position 0", board_mock.servo_position == 900 && board_mock.position_led[0]);
+
+    check("velocity limit", within_limits);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
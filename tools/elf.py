@@ -0,0 +1,100 @@
+"""
+elf reads sections and symbols of the 32 bit little endian ELF files built for the STM32.
+
+It is shared by the host tools and needs nothing but the python standard library.
+"""
+
+import struct
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+STT_FUNC = 2
+
+
+class Section:
+    def __init__(self, name, type, flags, address, offset, size, link):
+        self.name = name
+        self.type = type
+        self.flags = flags
+        self.address = address
+        self.offset = offset
+        self.size = size
+        self.link = link
+
+
+class Symbol:
+    def __init__(self, name, value, size, type):
+        self.name = name
+        self.value = value
+        self.size = size
+        self.type = type
+
+
+class Elf:
+    def __init__(self, path):
+        with open(path, 'rb') as file:
+            self.data = file.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError('%s is not a 32 bit little endian ELF file' % path)
+
+        (shoff,) = struct.unpack_from('<I', self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x2E)
+        headers = [struct.unpack_from('<IIIIIIIIII', self.data, shoff + i * shentsize) for i in range(shnum)]
+
+        names = headers[shstrndx]
+        self.sections = []
+        for name, type, flags, address, offset, size, link, _, _, _ in headers:
+            self.sections.append(Section(self._string(names[4], name), type, flags, address, offset, size, link))
+
+        self.symbols = []
+        for section in self.sections:
+            if section.type == SHT_SYMTAB:
+                strings = self.sections[section.link]
+                for offset in range(section.offset, section.offset + section.size, 16):
+                    name, value, size, info, _, _ = struct.unpack_from('<IIIBBH', self.data, offset)
+                    if name:
+                        self.symbols.append(Symbol(self._string(strings.offset, name), value, size, info & 0xF))
+
+    def _string(self, table, offset):
+        start = table + offset
+        return self.data[start:self.data.index(b'\0', start)].decode()
+
+    def section(self, name):
+        for section in self.sections:
+            if section.name == name:
+                return section
+        raise KeyError('section %s not found' % name)
+
+    def contents(self, section):
+        return self.data[section.offset:section.offset + section.size]
+
+    def symbol(self, name):
+        for symbol in self.symbols:
+            if symbol.name == name:
+                return symbol
+        raise KeyError('symbol %s not found' % name)
+
+    def functions(self):
+        """Functions sorted by address, the thumb bit is removed."""
+        return sorted((Symbol(s.name, s.value & ~1, s.size, s.type) for s in self.symbols if s.type == STT_FUNC),
+                      key=lambda s: s.value)
+
+    def read(self, address, size):
+        """Reads the initial content of the memory at address from the loaded sections."""
+        for section in self.sections:
+            if section.flags & SHF_ALLOC and section.type != SHT_NOBITS \
+                    and section.address <= address and address + size <= section.address + section.size:
+                start = section.offset + address - section.address
+                return self.data[start:start + size]
+        return None
+
+    def string(self, address):
+        """Reads a zero terminated string from the loaded sections."""
+        for section in self.sections:
+            if section.flags & SHF_ALLOC and section.type != SHT_NOBITS \
+                    and section.address <= address < section.address + section.size:
+                start = section.offset + address - section.address
+                end = self.data.index(b'\0', start)
+                return self.data[start:end].decode(errors='replace')
+        return None
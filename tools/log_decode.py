@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+log_decode prints the messages of the binary log (see src/runtime/log.h).
+
+The log buffer is dumped from the target with the debugger, e.g. with gdb:
+
+    dump binary memory log.bin &log_buffer (char *) &log_buffer + sizeof(log_buffer)
+
+and decoded with the format strings of the firmware:
+
+    tools/log_decode.py servo.elf log.bin
+
+A dump of the whole RAM can be used as well with --base 0x20000000.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elf import Elf
+
+LOG_ARGS = 3
+LOG_INVALID = 0xFFFFFFFF
+ENTRY_SIZE = 4 + 4 * LOG_ARGS
+
+CONVERSION = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXcsp%])')
+
+
+def format_message(elf, format, args):
+    args = list(args)
+
+    def convert(match):
+        flags, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        value = args.pop(0) if args else 0
+        if conversion in 'di':
+            value = value - (1 << 32) if value & 0x80000000 else value
+            return ('%' + flags + 'd') % value
+        if conversion == 'u':
+            return ('%' + flags + 'd') % value
+        if conversion == 'p':
+            return '0x%08x' % value
+        if conversion == 'c':
+            return chr(value & 0xFF)
+        if conversion == 's':
+            string = elf.string(value)
+            return ('%' + flags + 's') % (string if string is not None else '<0x%08x>' % value)
+        return ('%' + flags + conversion) % value
+
+    return CONVERSION.sub(convert, format)
+
+
+def decode(elf, dump):
+    formats = elf.contents(elf.section('.log_fmt'))
+    (head,) = struct.unpack_from('<I', dump, 0)
+    size = (len(dump) - 4) // ENTRY_SIZE
+    first = max(0, head - size)
+    for index in range(first, head):
+        format, *args = struct.unpack_from('<I%dI' % LOG_ARGS, dump, 4 + (index % size) * ENTRY_SIZE)
+        if format == LOG_INVALID or format >= len(formats):
+            yield index, '<entry being written>'
+            continue
+        text = formats[format:formats.index(b'\0', format)].decode(errors='replace')
+        yield index, format_message(elf, text, args)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodes the binary log of the firmware.')
+    parser.add_argument('elf', help='ELF file of the firmware')
+    parser.add_argument('dump', help='binary dump of log_buffer')
+    parser.add_argument('--base', type=lambda x: int(x, 0),
+                        help='address of the dump, if it is not a dump of log_buffer')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    with open(args.dump, 'rb') as file:
+        dump = file.read()
+
+    symbol = elf.symbol('log_buffer')
+    if args.base is not None:
+        dump = dump[symbol.value - args.base:symbol.value - args.base + symbol.size]
+    else:
+        dump = dump[:symbol.size]
+    if len(dump) < symbol.size:
+        sys.exit('dump is smaller than log_buffer (%d bytes)' % symbol.size)
+
+    for index, message in decode(elf, dump):
+        print('%6d %s' % (index, message))
+
+
+if __name__ == '__main__':
+    main()
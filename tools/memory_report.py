@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+memory_report prints the flash and RAM usage of a firmware from the map file of the linker
+and checks it against the budget in memory-budget.json.
+
+    tools/memory_report.py arm/servo.map --budget memory-budget.json --firmware servo
+
+The usage is broken down per output section and per object file.
+Flash are the sections that are loaded into the ROM region (code, constants and the initial values of data),
+RAM are the sections in the RAM region (data, bss and the stack).
+With link time optimization the code of the LTO objects is reported as one object.
+Padding and the stack are reported with the name of their section, e.g. (.stack).
+
+The check fails if the flash or the RAM usage exceeds the budget by more than `tolerance_percent`
+or if the firmware has no budget. A smaller usage is reported, so the budget can be lowered.
+--update records the current usage as the budget of the firmware.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+HEX = r'0x([0-9a-fA-F]+)'
+SECTION = re.compile(r'^(\S+)(?:\s+' + HEX + r'\s+' + HEX + r'(?:\s+load address ' + HEX + r')?)?\s*$')
+SECTION_CONTINUED = re.compile(r'^\s+' + HEX + r'\s+' + HEX + r'(?:\s+load address ' + HEX + r')?\s*$')
+INPUT = re.compile(r'^ (\S+)(?:\s+' + HEX + r'\s+' + HEX + r'(?:\s+(\S.*))?)?\s*$')
+INPUT_CONTINUED = re.compile(r'^\s+' + HEX + r'\s+' + HEX + r'(?:\s+(\S.*))?\s*$')
+REGION = re.compile(r'^(\S+)\s+' + HEX + r'\s+' + HEX)
+LTO_OBJECT = re.compile(r'\.ltrans\d*\.ltrans\.o$|\.ltrans\d+\.o$')
+
+
+class OutputSection:
+    def __init__(self, name, address, size, load):
+        self.name = name
+        self.address = address
+        self.size = size
+        self.load = load if load is not None else address
+        self.inputs = []
+
+
+def object_name(path):
+    """Short name of an object: the file name or the member of an archive."""
+    path = path.strip()
+    if LTO_OBJECT.search(path):
+        return '(link time optimized)'
+    match = re.match(r'^(.*?)([^/\\]+\.a)\((.*)\)$', path)
+    if match:
+        return '%s(%s)' % (match.group(2), match.group(3))
+    return os.path.basename(path)
+
+
+def parse(lines):
+    """Returns the memory regions {name: (origin, length)} and the output sections of a map file."""
+    regions = {}
+    sections = []
+    state = None
+    pending = None
+    for line in lines:
+        line = line.rstrip('\n')
+        if line.startswith('Memory Configuration'):
+            state = 'regions'
+            continue
+        if line.startswith('Linker script and memory map'):
+            state = 'map'
+            continue
+        if state == 'regions':
+            match = REGION.match(line)
+            if match and match.group(1) != '*default*':
+                regions[match.group(1)] = (int(match.group(2), 16), int(match.group(3), 16))
+            continue
+        if state != 'map' or not line.strip():
+            pending = None
+            continue
+        if line.startswith(('LOAD ', 'OUTPUT(', 'START GROUP', 'END GROUP')):
+            continue
+
+        if pending is not None:
+            kind, name = pending
+            pending = None
+            if kind == 'section':
+                match = SECTION_CONTINUED.match(line)
+                if match:
+                    sections.append(new_section(name, match.group(1), match.group(2), match.group(3)))
+                    continue
+            else:
+                match = INPUT_CONTINUED.match(line)
+                if match and sections:
+                    add_input(sections[-1], name, match.group(1), match.group(2), match.group(3))
+                    continue
+
+        if not line[0].isspace():
+            match = SECTION.match(line)
+            if match:
+                if match.group(2) is None:
+                    pending = ('section', match.group(1))
+                else:
+                    sections.append(new_section(match.group(1), match.group(2), match.group(3), match.group(4)))
+            continue
+        match = INPUT.match(line)
+        if match and not match.group(1).startswith('0x') and '(' not in match.group(1)[:1]:
+            if match.group(2) is None:
+                pending = ('input', match.group(1))
+            elif sections:
+                add_input(sections[-1], match.group(1), match.group(2), match.group(3), match.group(4))
+    return regions, sections
+
+
+def new_section(name, address, size, load):
+    return OutputSection(name, int(address, 16), int(size, 16), int(load, 16) if load else None)
+
+
+def add_input(section, name, address, size, path):
+    if name == '*fill*':
+        path = None
+    elif name.startswith('*'):
+        return
+    section.inputs.append((object_name(path) if path else '(%s)' % section.name, int(size, 16)))
+
+
+def region_of(regions, address):
+    for name, (origin, length) in regions.items():
+        if origin <= address < origin + length:
+            return name
+    return None
+
+
+def usage(regions, sections, flash_region, ram_region):
+    """Flash and RAM usage of the sections and of the objects"""
+    per_section = {}
+    per_object = {}
+    for section in sections:
+        if section.size == 0:
+            continue
+        flash = section.size if region_of(regions, section.load) == flash_region else 0
+        ram = section.size if region_of(regions, section.address) == ram_region else 0
+        if flash == 0 and ram == 0:
+            continue
+        per_section[section.name] = (flash, ram)
+        accounted = 0
+        for name, size in section.inputs:
+            accounted += size
+            add(per_object, name, size if flash else 0, size if ram else 0)
+        rest = section.size - accounted
+        if rest > 0:
+            add(per_object, '(%s)' % section.name, rest if flash else 0, rest if ram else 0)
+    return per_section, per_object
+
+
+def add(table, name, flash, ram):
+    old_flash, old_ram = table.get(name, (0, 0))
+    table[name] = (old_flash + flash, old_ram + ram)
+
+
+def print_table(title, table, limit=None):
+    print('%-40s %8s %8s' % (title, 'flash', 'RAM'))
+    rows = sorted(table.items(), key=lambda item: -(item[1][0] + item[1][1]))
+    for name, (flash, ram) in rows[:limit]:
+        print('%-40s %8d %8d' % (name, flash, ram))
+    if limit is not None and len(rows) > limit:
+        flash = sum(value[0] for _, value in rows[limit:])
+        ram = sum(value[1] for _, value in rows[limit:])
+        print('%-40s %8d %8d' % ('(%d more)' % (len(rows) - limit), flash, ram))
+    print()
+
+
+def check(name, used, budget, tolerance):
+    """Returns an error message if used exceeds the budget by more than tolerance percent."""
+    difference = used - budget
+    if difference > budget * tolerance / 100:
+        return '%s grew by %d bytes to %d bytes, the budget is %d bytes with a tolerance of %g%%' % (
+            name, difference, used, budget, tolerance)
+    if difference < 0:
+        print('%s is %d bytes below the budget of %d bytes' % (name, -difference, budget))
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Prints the memory usage of a firmware and checks its budget.')
+    parser.add_argument('map', help='map file of the linker')
+    parser.add_argument('--budget', help='budget file (JSON)')
+    parser.add_argument('--firmware', help='name of the firmware in the budget file (default name of the map file)')
+    parser.add_argument('--update', action='store_true', help='record the usage as the budget')
+    parser.add_argument('--output', help='write the report to this file if the check passes')
+    parser.add_argument('--flash-region', default='ROM', help='memory region of the flash (default ROM)')
+    parser.add_argument('--ram-region', default='RAM', help='memory region of the RAM (default RAM)')
+    parser.add_argument('--objects', type=int, default=20, help='number of objects to print (default 20)')
+    args = parser.parse_args()
+
+    firmware = args.firmware or os.path.splitext(os.path.basename(args.map))[0]
+    with open(args.map) as file:
+        regions, sections = parse(file)
+    if args.flash_region not in regions or args.ram_region not in regions:
+        sys.exit('%s: no memory regions %s and %s' % (args.map, args.flash_region, args.ram_region))
+
+    per_section, per_object = usage(regions, sections, args.flash_region, args.ram_region)
+    flash = sum(value[0] for value in per_section.values())
+    ram = sum(value[1] for value in per_section.values())
+
+    if args.output:
+        sys.stdout = Report(sys.stdout)
+    flash_size = regions[args.flash_region][1]
+    ram_size = regions[args.ram_region][1]
+    print('%s: flash %d of %d bytes (%.1f%%), RAM %d of %d bytes (%.1f%%)' % (
+        firmware, flash, flash_size, 100 * flash / flash_size, ram, ram_size, 100 * ram / ram_size))
+    print()
+    print_table('section', per_section)
+    print_table('object', per_object, args.objects)
+
+    if not args.budget:
+        return
+    budget = {'tolerance_percent': 1, 'firmware': {}}
+    if os.path.exists(args.budget):
+        with open(args.budget) as file:
+            budget = json.load(file)
+
+    if args.update:
+        budget.setdefault('firmware', {})[firmware] = {'flash': flash, 'ram': ram}
+        with open(args.budget, 'w') as file:
+            json.dump(budget, file, indent=4, sort_keys=True)
+            file.write('\n')
+        print('budget of %s updated' % firmware)
+        return
+
+    limits = budget.get('firmware', {}).get(firmware)
+    if limits is None or 'flash' not in limits or 'ram' not in limits:
+        sys.exit('%s: no budget in %s, record it with --update (target memory-budget)' % (firmware, args.budget))
+    tolerance = budget.get('tolerance_percent', 0)
+    errors = [error for error in (check('flash', flash, limits['flash'], tolerance),
+                                  check('RAM', ram, limits['ram'], tolerance)) if error]
+    if errors:
+        sys.exit('\n'.join('%s: %s' % (firmware, error) for error in errors))
+
+    if args.output:
+        with open(args.output, 'w') as file:
+            file.write(sys.stdout.text)
+
+
+class Report:
+    """Prints and collects the report."""
+    def __init__(self, stream):
+        self.stream = stream
+        self.text = ''
+
+    def write(self, text):
+        self.stream.write(text)
+        self.text += text
+
+    def flush(self):
+        self.stream.flush()
+
+
+if __name__ == '__main__':
+    main()
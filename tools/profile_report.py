@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+profile_report prints a flat profile from the samples of the profiler (see src/runtime/profile.h).
+
+The histogram is dumped from the target with the debugger, e.g. with gdb:
+
+    dump binary memory profile.bin &profile (char *) &profile + sizeof(profile)
+
+and mapped to the functions of the firmware with:
+
+    tools/profile_report.py servo.elf profile.bin
+
+A dump of the whole RAM can be used as well with --base 0x20000000.
+The samples of a bin are split between the functions it overlaps by the number of bytes.
+"""
+
+import argparse
+import struct
+import sys
+
+from elf import Elf
+
+FLASH_BASE = 0x08000000
+
+
+def functions_of_bin(functions, start, end):
+    """Yields the functions overlapping [start, end) and the number of overlapping bytes."""
+    for function in functions:
+        overlap = min(end, function.value + max(function.size, 1)) - max(start, function.value)
+        if overlap > 0:
+            yield function.name, overlap
+
+
+def report(elf, dump, limit):
+    shift, samples, other = struct.unpack_from('<III', dump, 0)
+    count = (len(dump) - 12) // 2
+    bins = struct.unpack_from('<%dH' % count, dump, 12)
+    functions = elf.functions()
+
+    profile = {}
+    for index, value in enumerate(bins):
+        if value == 0:
+            continue
+        start = FLASH_BASE + (index << shift)
+        end = start + (1 << shift)
+        overlaps = list(functions_of_bin(functions, start, end))
+        covered = sum(size for _, size in overlaps)
+        if covered == 0:
+            profile['<0x%08x>' % start] = profile.get('<0x%08x>' % start, 0) + value
+            continue
+        for name, size in overlaps:
+            profile[name] = profile.get(name, 0) + value * size / covered
+
+    if samples == 0:
+        print('no samples')
+        return
+    print('%d samples, %d outside of the flash, bins of %d bytes' % (samples, other, 1 << shift))
+    print()
+    print('     %    samples  function')
+    for name, value in sorted(profile.items(), key=lambda item: -item[1])[:limit]:
+        print('%6.2f %10.1f  %s' % (100 * value / samples, value, name))
+    if max(bins) == 0xFFFF:
+        print('\nsome bins are saturated, the profile is distorted')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Prints the flat profile of the sampling profiler.')
+    parser.add_argument('elf', help='ELF file of the firmware')
+    parser.add_argument('dump', help='binary dump of profile')
+    parser.add_argument('--base', type=lambda x: int(x, 0), help='address of the dump, if it is a RAM dump')
+    parser.add_argument('--limit', type=int, default=30, help='number of functions to print (default 30)')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    with open(args.dump, 'rb') as file:
+        dump = file.read()
+
+    symbol = elf.symbol('profile')
+    if args.base is not None:
+        dump = dump[symbol.value - args.base:symbol.value - args.base + symbol.size]
+    else:
+        dump = dump[:symbol.size]
+    if len(dump) < symbol.size:
+        sys.exit('dump is smaller than profile (%d bytes)' % symbol.size)
+
+    report(elf, dump, args.limit)
+
+
+if __name__ == '__main__':
+    main()
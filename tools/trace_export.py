@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+trace_export converts the trace of the firmware (see src/runtime/trace.h)
+into the Chrome trace format for chrome://tracing or https://ui.perfetto.dev.
+
+The trace buffer is dumped from the target with the debugger, e.g. with gdb:
+
+    dump binary memory trace.bin &trace_buffer (char *) &trace_buffer + sizeof(trace_buffer)
+
+and converted with:
+
+    tools/trace_export.py trace.bin trace.json --frequency 72000000
+
+A dump of the whole RAM can be used together with the ELF file:
+
+    tools/trace_export.py ram.bin trace.json --elf servo.elf --base 0x20000000
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+TRACE_DELTA_BITS = 20
+
+TRACE_TIME = 0
+TRACE_BEAT = 1
+TRACE_STEP_BEGIN = 2
+TRACE_STEP_END = 3
+TRACE_IRQ_ENTER = 4
+TRACE_IRQ_EXIT = 5
+TRACE_USER = 6
+
+THREAD_BEAT = 0
+THREAD_STEP = 1
+THREAD_IRQ = 2
+THREAD_USER = 3
+
+THREAD_NAMES = {
+    THREAD_BEAT: 'beat',
+    THREAD_STEP: 'step',
+    THREAD_IRQ: 'interrupts',
+    THREAD_USER: 'user',
+}
+
+# Handler names of the vector table by exception number
+VECTORS = [
+    None, 'reset', 'nmi', 'hard_fault', 'mem_mgnt_fault', 'bus_fault', 'usage_fault',
+    None, None, None, None, 'sv_call', 'debug_mon', None, 'pend_sv', 'sys_tick',
+    'win_watchdog', 'pvd', 'tamper', 'rtc', 'flash', 'rcc',
+    'ext_int0', 'ext_int1', 'ext_int2', 'ext_int3', 'ext_int4',
+    'dma_channel1', 'dma_channel2', 'dma_channel3', 'dma_channel4',
+    'dma_channel5', 'dma_channel6', 'dma_channel7',
+    'adc1_2', 'usb_hp_can1_tx0', 'usb_lp_can1_rx0', 'can1_rx1', 'can1_sce', 'ext_int9_5',
+    'timer1_brk', 'timer1_up', 'timer1_trg_com', 'timer1_cc', 'timer2', 'timer3', 'timer4',
+    'i2c1_ev', 'i2c1_er', 'i2c2_ev', 'i2c2_er', 'spi1', 'spi2',
+    'usart1', 'usart2', 'usart3', 'ext_int15_10', 'rtc_alarm', 'usb_wakeup',
+]
+
+
+def vector_name(vector):
+    name = VECTORS[vector] if vector < len(VECTORS) else None
+    return 'on_' + name if name else 'vector %d' % vector
+
+
+def decode(dump):
+    """Yields (cycles, event, data) of the recorded events, the oldest first."""
+    head, last = struct.unpack_from('<II', dump, 0)
+    size = (len(dump) - 8) // 4
+    words = struct.unpack_from('<%dI' % size, dump, 8)
+
+    events = []
+    time = 0
+    upper = 0
+    for index in range(max(0, head - size), head):
+        word = words[index % size]
+        delta, event, data = word >> 12, (word >> 8) & 0xF, word & 0xFF
+        if event == TRACE_TIME:
+            upper = delta << TRACE_DELTA_BITS
+            continue
+        time += upper + delta
+        upper = 0
+        events.append((time, event, data))
+
+    # anchor the timeline at the cycle counter of the latest event
+    offset = last - time
+    return [(time + offset, event, data) for time, event, data in events]
+
+
+def export(events, frequency):
+    trace = [{'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': tid, 'args': {'name': name}}
+             for tid, name in THREAD_NAMES.items()]
+    depth = {THREAD_STEP: 0, THREAD_IRQ: 0}
+
+    def add(phase, tid, name, cycles, **args):
+        if phase == 'B':
+            depth[tid] += 1
+        elif phase == 'E':
+            if depth[tid] == 0:
+                return  # the begin has been overwritten in the ring buffer
+            depth[tid] -= 1
+        entry = {'name': name, 'ph': phase, 'pid': 0, 'tid': tid, 'ts': cycles * 1e6 / frequency}
+        if phase == 'i':
+            entry['s'] = 't'
+        if args:
+            entry['args'] = args
+        trace.append(entry)
+
+    for cycles, event, data in events:
+        if event == TRACE_BEAT:
+            add('i', THREAD_BEAT, 'beat', cycles, beat=data)
+        elif event == TRACE_STEP_BEGIN:
+            add('B', THREAD_STEP, 'step', cycles, beat=data)
+        elif event == TRACE_STEP_END:
+            add('E', THREAD_STEP, 'step', cycles)
+        elif event == TRACE_IRQ_ENTER:
+            add('B', THREAD_IRQ, vector_name(data), cycles)
+        elif event == TRACE_IRQ_EXIT:
+            add('E', THREAD_IRQ, vector_name(data), cycles)
+        elif event == TRACE_USER:
+            add('i', THREAD_USER, 'user', cycles, data=data)
+
+    return {'traceEvents': trace, 'displayTimeUnit': 'ns'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Converts a trace dump into the Chrome trace format.')
+    parser.add_argument('dump', help='binary dump of trace_buffer')
+    parser.add_argument('output', help='JSON file to write')
+    parser.add_argument('--frequency', type=float, default=8e6, help='core clock in Hz (default 8 MHz)')
+    parser.add_argument('--elf', help='ELF file of the firmware, to locate trace_buffer in a RAM dump')
+    parser.add_argument('--base', type=lambda x: int(x, 0), help='address of the RAM dump')
+    args = parser.parse_args()
+
+    with open(args.dump, 'rb') as file:
+        dump = file.read()
+
+    if args.base is not None:
+        if not args.elf:
+            sys.exit('--base requires --elf')
+        from elf import Elf
+        symbol = Elf(args.elf).symbol('trace_buffer')
+        dump = dump[symbol.value - args.base:symbol.value - args.base + symbol.size]
+
+    events = decode(dump)
+    with open(args.output, 'w') as file:
+        json.dump(export(events, args.frequency), file, indent=1)
+    print('%d events written to %s' % (len(events), args.output))
+
+
+if __name__ == '__main__':
+    main()